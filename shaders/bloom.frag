@@ -9,6 +9,7 @@ uniform sampler2D texture0;
 uniform vec4 colDiffuse;
 
 uniform vec2 size;
+uniform float intensity = 1.0f;
 const float samples = 12.0f;
 const float quality = 6.0f;
 
@@ -24,5 +25,5 @@ void main() {
         }
     }
 
-    color = ((sum / (samples * samples)) + source) * colDiffuse;
+    color = ((sum / (samples * samples)) * intensity + source) * colDiffuse;
 }
\ No newline at end of file
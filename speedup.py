@@ -0,0 +1,52 @@
+import sys, re, argparse, subprocess, shlex, math
+
+# Runs the same benchmarks on the plain, release and PGO builds and prints how much faster the optimised ones are.
+# Simulation numbers come from --microbench (ns/op); render numbers from --compare-post (ms/frame) offscreen.
+def run(command: list[str]) -> str:
+    return subprocess.run(command, stdout = subprocess.PIPE, stderr = subprocess.DEVNULL, text = True).stdout
+
+def benchmarks(binary: str, renderer: list[str]) -> dict[str, float]:
+    results = {}
+
+    for line in run([binary, "--seed", "1", "--microbench"]).splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[0] != "benchmark":
+            results[fields[0]] = float(fields[2])
+
+    for line in run(renderer + [binary, "--headless", "--resolution", "1280", "720", "--seed", "1", "--compare-post"]).splitlines():
+        match = re.match(r"\s*(shader|software):\s+([\d.]+) ms/frame", line)
+        if match and float(match.group(2)) > 0.0:
+            results[f"post ({match.group(1)})"] = float(match.group(2)) * 1e6
+
+    return results
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--plain", required = True)
+    parser.add_argument("--release", required = True)
+    parser.add_argument("--pgo", required = True)
+    parser.add_argument("--renderer", default = "")
+    arguments = parser.parse_args(argv[1:])
+
+    renderer = shlex.split(arguments.renderer)
+    builds = { name: benchmarks(binary, renderer) for name, binary in (("plain", arguments.plain), ("release", arguments.release), ("pgo", arguments.pgo)) }
+    names = [name for name in builds["plain"] if all(name in results for results in builds.values())]
+
+    print(f"{'benchmark':<32} {'plain ns':>12} {'release ns':>12} {'pgo ns':>12} {'release x':>10} {'pgo x':>10}")
+    logs = { "release": 0.0, "pgo": 0.0 }
+
+    for name in names:
+        plain, release, pgo = builds["plain"][name], builds["release"][name], builds["pgo"][name]
+        logs["release"] += math.log(plain / release)
+        logs["pgo"] += math.log(plain / pgo)
+        print(f"{name:<32} {plain:>12.2f} {release:>12.2f} {pgo:>12.2f} {plain / release:>10.2f} {plain / pgo:>10.2f}")
+
+    if not names:
+        print("no benchmark ran on all three builds")
+        return 1
+
+    print(f"geometric mean speedup over {len(names)} benchmarks: release {math.exp(logs['release'] / len(names)):.2f}x, pgo {math.exp(logs['pgo'] / len(names)):.2f}x")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,87 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+
+#include "Allocations.hpp"
+
+static std::atomic<uint64_t> allocationCount { 0 }, allocationBytes { 0 };
+static std::atomic<int64_t> live[Allocations::Categories + 1], peak[Allocations::Categories + 1];
+static thread_local Allocations::Category active = Allocations::General;
+
+// Each block carries its size and category in front so frees can be credited to the right category.
+struct alignas(alignof(std::max_align_t)) Header {
+    uint64_t size;
+    Allocations::Category category;
+};
+
+uint64_t Allocations::Count() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t Allocations::Bytes() {
+    return allocationBytes.load(std::memory_order_relaxed);
+}
+
+int64_t Allocations::Current(Category category) {
+    return live[category].load(std::memory_order_relaxed);
+}
+
+int64_t Allocations::Peak(Category category) {
+    return peak[category].load(std::memory_order_relaxed);
+}
+
+int64_t Allocations::Current() {
+    return live[Categories].load(std::memory_order_relaxed);
+}
+
+int64_t Allocations::Peak() {
+    return peak[Categories].load(std::memory_order_relaxed);
+}
+
+const char* Allocations::Name(Category category) {
+    static const char* const names[] = { "general", "entities", "snapshots", "track", "post-process", "capture", "rewind", "audio" };
+    return category < Categories ? names[category] : "total";
+}
+
+Allocations::Category Allocations::Enter(Category category) {
+    Category previous = active;
+    active = category;
+    return previous;
+}
+
+static void Charge(int index, int64_t size) {
+    int64_t now = live[index].fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t high = peak[index].load(std::memory_order_relaxed);
+    while (now > high && !peak[index].compare_exchange_weak(high, now, std::memory_order_relaxed)) {}
+}
+
+static void* Allocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* block = std::malloc(sizeof(Header) + size)) {
+        Header* header = (Header*) block;
+        header->size = size, header->category = active;
+        Charge(active, (int64_t) size), Charge(Allocations::Categories, (int64_t) size);
+        return header + 1;
+    }
+
+    throw std::bad_alloc();
+}
+
+static void Free(void* pointer) {
+    if (!pointer) return;
+
+    Header* header = (Header*) pointer - 1;
+    live[header->category].fetch_sub((int64_t) header->size, std::memory_order_relaxed);
+    live[Allocations::Categories].fetch_sub((int64_t) header->size, std::memory_order_relaxed);
+    std::free(header);
+}
+
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void operator delete(void* pointer) noexcept { Free(pointer); }
+void operator delete[](void* pointer) noexcept { Free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { Free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { Free(pointer); }
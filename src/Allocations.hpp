@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+// Process-wide counters fed by the replacement operator new in Allocations.cpp. Every allocation is charged
+// to the category of the innermost Scope on the allocating thread and credited back to it when freed.
+namespace Allocations {
+    enum Category : uint8_t { General, Entities, Snapshots, Track, PostProcess, Capture, Rewind, Audio, Categories };
+
+    uint64_t Count();
+    uint64_t Bytes();
+
+    // Live bytes and their high-water mark, per category or over all of them.
+    int64_t Current(Category category);
+    int64_t Peak(Category category);
+    int64_t Current();
+    int64_t Peak();
+
+    const char* Name(Category category);
+
+    Category Enter(Category category);
+
+    class Scope {
+        private:
+            Category previous;
+
+        public:
+            explicit Scope(Category category) : previous(Enter(category)) {}
+            ~Scope() { Enter(previous); }
+    };
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "Solvability.hpp"
+
+// Plans a path through the next few obstacles with the point reachability model of Solvability::Step(), which
+// is optimistic but cheap enough to rerun every frame. Walking the rows backwards, each row keeps the set of
+// lateral positions from which every later row can still be passed, so the search over (row, position) states
+// is memoised into one 33-bit mask per row and costs a few shifts per obstacle. The player then heads for the
+// closest position that is both reachable now and safe for the whole look-ahead.
+class Autopilot {
+    private:
+        struct Row {
+            float z, lane;
+        };
+
+        static constexpr int lookahead = 16;
+        std::vector<Row> rows;
+        uint64_t safe[lookahead + 1];
+
+    public:
+        void Clear() {
+            rows.clear();
+        }
+
+        // Obstacles behind the player are ignored; ones still beside it count as the first row.
+        void Add(float z, float lane, float playerZ) {
+            if (z < playerZ + Solvability::half) rows.push_back({ z, lane });
+        }
+
+        // Returns -1 to steer left, 1 to steer right and 0 to hold. `step` is how far one tick of steering moves
+        // targetX, which sets the dead band so the target does not oscillate around the goal.
+        int Plan(float x, float targetX, float playerZ, float speed, float step) {
+            int count = std::min((int) rows.size(), lookahead);
+            auto closer = [](const Row& a, const Row& b) { return a.z > b.z; };
+
+            if ((int) rows.size() > count) std::partial_sort(rows.begin(), rows.begin() + count, rows.end(), closer);
+            else std::sort(rows.begin(), rows.end(), closer);
+
+            safe[count] = Solvability::all;
+            for (int row = count - 1; row >= 0; row--) {
+                float gap = row + 1 < count ? rows[row].z - rows[row + 1].z : Solvability::rowSpacing;
+                safe[row] = Solvability::Step(safe[row + 1], rows[row].lane, Solvability::ReachSteps(speed, std::max(gap, 0.0f)));
+            }
+
+            uint64_t candidates = safe[0];
+            if (count > 0) {
+                uint64_t reachable = Solvability::Dilate(uint64_t(1) << Solvability::Bit(x), Solvability::ReachSteps(speed, std::max(playerZ - rows[0].z, 0.0f)));
+                if (reachable & candidates) candidates &= reachable;
+            }
+
+            if (candidates == 0) return 0;
+
+            int current = Solvability::Bit(targetX), goal = -1;
+            for (int bit = 0; bit < Solvability::positions; bit++)
+                if ((candidates >> bit & 1) && (goal < 0 || std::abs(bit - current) < std::abs(goal - current))) goal = bit;
+
+            float goalX = Solvability::Position(goal), band = std::max(Solvability::resolution, step) * 0.5f;
+            if (goalX < targetX - band) return -1;
+            if (goalX > targetX + band) return 1;
+            return 0;
+        }
+};
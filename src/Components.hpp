@@ -0,0 +1,32 @@
+#pragma once
+
+#include <raylib/raylib.h>
+
+#include "Ecs.hpp"
+
+struct Location {
+    Vector3 position;
+};
+
+struct Bounds {
+    Vector3 size;
+};
+
+struct Tint {
+    Color color;
+};
+
+struct PlayerTag {};
+struct ObstacleTag {};
+
+using Players = Archetype<PlayerTag, Location, Bounds, Tint>;
+using Obstacles = Archetype<ObstacleTag, Location, Bounds, Tint>;
+using GameWorld = World<Players, Obstacles>;
+
+// Same test and rounding as CheckCollisionBoxes on the boxes around both centres: boxes that only touch collide.
+inline bool Overlaps(const Location& a, const Bounds& as, const Location& b, const Bounds& bs) {
+    const Vector3 p = a.position, q = b.position;
+    return p.x + as.size.x / 2 >= q.x - bs.size.x / 2 && p.x - as.size.x / 2 <= q.x + bs.size.x / 2
+        && p.y + as.size.y / 2 >= q.y - bs.size.y / 2 && p.y - as.size.y / 2 <= q.y + bs.size.y / 2
+        && p.z + as.size.z / 2 >= q.z - bs.size.z / 2 && p.z - as.size.z / 2 <= q.z + bs.size.z / 2;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include <raylib/raylib.h>
+
+// Records draw calls for one pass, sorts them by material and then front to back from the camera, and submits
+// them in that order so opaque geometry near the camera fills the depth buffer first and hides what is behind.
+class DrawQueue {
+    public:
+        enum Material : uint8_t { Cubes = 0, Floor = 1 };
+
+    private:
+        struct Command {
+            Material material;
+            Vector3 position, size;
+            Color color;
+        };
+
+        Vector3 eye = { 0.0f, 0.0f, 0.0f };
+        std::vector<Command> commands;
+        std::vector<uint64_t> keys, scratch;
+
+        // Material in the high byte, squared distance in the low word. Non-negative floats order the same as their bits.
+        uint64_t Key(Material material, Vector3 position) const {
+            float dx = position.x - eye.x, dy = position.y - eye.y, dz = position.z - eye.z;
+            float distance = dx * dx + dy * dy + dz * dz;
+            uint32_t bits;
+            std::memcpy(&bits, &distance, sizeof(bits));
+            return (uint64_t) material << 56 | (uint64_t) bits << 24;
+        }
+
+        // LSD radix sort on bytes, carrying the command index in the low 24 bits. Bytes that are equal across
+        // every key are skipped, which is most of them for a frame with a single material.
+        void Sort() {
+            size_t counts[8][256] = {};
+            for (uint64_t key : keys)
+                for (int digit = 0; digit < 8; digit++) counts[digit][(key >> (digit * 8)) & 0xFF]++;
+
+            scratch.resize(keys.size());
+
+            for (int digit = 3; digit < 8; digit++) {
+                size_t* count = counts[digit];
+                if (count[(keys[0] >> (digit * 8)) & 0xFF] == keys.size()) continue;
+
+                size_t offset = 0;
+                for (int bucket = 0; bucket < 256; bucket++) {
+                    size_t size = count[bucket];
+                    count[bucket] = offset, offset += size;
+                }
+
+                for (uint64_t key : keys) scratch[count[(key >> (digit * 8)) & 0xFF]++] = key;
+                keys.swap(scratch);
+            }
+        }
+
+    public:
+        // Starts a new pass. Storage is kept between passes so steady state recording does not allocate.
+        void Begin(const Camera3D& camera) {
+            eye = camera.position;
+            commands.clear(), keys.clear();
+        }
+
+        void Cube(Vector3 position, Vector3 size, Color color) {
+            keys.push_back(Key(Cubes, position) | commands.size());
+            commands.push_back({ Cubes, position, size, color });
+        }
+
+        void Plane(Vector3 position, Vector2 size, Color color) {
+            keys.push_back(Key(Floor, position) | commands.size());
+            commands.push_back({ Floor, position, { size.x, 0.0f, size.y }, color });
+        }
+
+        size_t Size() const {
+            return commands.size();
+        }
+
+        // Must be called inside BeginMode3D. Holds up to 2^24 commands per pass.
+        void Submit() {
+            if (keys.empty()) return;
+            Sort();
+
+            for (uint64_t key : keys) {
+                const Command& command = commands[key & 0xFFFFFF];
+                if (command.material == Floor) DrawPlane(command.position, { command.size.x, command.size.z }, command.color);
+                else DrawCube(command.position, command.size.x, command.size.y, command.size.z, command.color);
+            }
+        }
+};
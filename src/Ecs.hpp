@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+// Storage for every entity of one kind. Entities live in fixed size chunks that hold one contiguous array per
+// component, so systems walk plain arrays instead of chasing a pointer per entity. `Tag` only names the kind.
+// Removal swaps the last entity into the hole, so indices are not stable across removals.
+template <typename Tag, typename... Components>
+class Archetype {
+    public:
+        static constexpr size_t chunkSize = 256;
+
+        struct Chunk {
+            size_t count = 0;
+            std::tuple<std::array<Components, chunkSize>...> columns;
+
+            template <typename Component>
+            Component* Column() { return std::get<std::array<Component, chunkSize>>(columns).data(); }
+        };
+
+        template <typename Component>
+        static constexpr bool Contains() {
+            return (std::is_same_v<Component, Components> || ...);
+        }
+
+        template <typename... Query>
+        static constexpr bool Has() {
+            return (Contains<Query>() && ...);
+        }
+
+    private:
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        size_t size = 0;
+
+        template <typename Component>
+        Component& Slot(size_t index) {
+            return chunks[index / chunkSize]->template Column<Component>()[index % chunkSize];
+        }
+
+    public:
+        size_t Size() const {
+            return size;
+        }
+
+        size_t Add(const Components&... components) {
+            if (size == chunks.size() * chunkSize) chunks.push_back(std::make_unique<Chunk>());
+
+            Chunk& chunk = *chunks[size / chunkSize];
+            ((chunk.template Column<Components>()[chunk.count] = components), ...);
+            chunk.count++;
+            return size++;
+        }
+
+        void Remove(size_t index) {
+            size_t last = size - 1;
+            if (index != last) ((Slot<Components>(index) = Slot<Components>(last)), ...);
+
+            chunks[last / chunkSize]->count--;
+            size--;
+        }
+
+        // Keeps the chunks allocated so the next fill does not allocate.
+        void Clear() {
+            for (auto& chunk : chunks) chunk->count = 0;
+            size = 0;
+        }
+
+        template <typename Component>
+        Component& Get(size_t index) {
+            return Slot<Component>(index);
+        }
+
+        // Calls fn(count, Query*...) once per non-empty chunk.
+        template <typename... Query, typename Function>
+        void EachChunk(Function&& fn) {
+            for (auto& chunk : chunks) {
+                if (chunk->count == 0) break;
+                fn(chunk->count, chunk->template Column<Query>()...);
+            }
+        }
+
+        template <typename... Query, typename Function>
+        void Each(Function&& fn) {
+            EachChunk<Query...>([&](size_t count, Query*... columns) {
+                for (size_t i = 0; i < count; i++) fn(columns[i]...);
+            });
+        }
+};
+
+// A fixed set of archetypes. Queries visit every archetype that has all of the requested components.
+template <typename... Archetypes>
+class World {
+    private:
+        std::tuple<Archetypes...> archetypes;
+
+    public:
+        template <typename Kind>
+        Kind& Get() {
+            return std::get<Kind>(archetypes);
+        }
+
+        template <typename... Query, typename Function>
+        void EachChunk(Function&& fn) {
+            std::apply([&](auto&... archetype) {
+                ([&](auto& kind) {
+                    if constexpr (std::decay_t<decltype(kind)>::template Has<Query...>()) kind.template EachChunk<Query...>(fn);
+                }(archetype), ...);
+            }, archetypes);
+        }
+
+        // Calls fn(Query&...) for every entity that has the components, chunk by chunk.
+        template <typename... Query, typename Function>
+        void Each(Function&& fn) {
+            EachChunk<Query...>([&](size_t count, Query*... columns) {
+                for (size_t i = 0; i < count; i++) fn(columns[i]...);
+            });
+        }
+};
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+
+#include <raylib/raylib.h>
+
+#include "SpscQueue.hpp"
+
+#if defined(_WIN32)
+    #define CAPTURE_APIENTRY __stdcall
+#else
+    #define CAPTURE_APIENTRY
+#endif
+
+// raylib does not expose pixel buffer objects, but its GL loader's function pointers are public symbols.
+extern "C" {
+    extern void (CAPTURE_APIENTRY *glad_glGenBuffers)(int, unsigned int*);
+    extern void (CAPTURE_APIENTRY *glad_glDeleteBuffers)(int, const unsigned int*);
+    extern void (CAPTURE_APIENTRY *glad_glBindBuffer)(unsigned int, unsigned int);
+    extern void (CAPTURE_APIENTRY *glad_glBufferData)(unsigned int, intptr_t, const void*, unsigned int);
+    extern void* (CAPTURE_APIENTRY *glad_glMapBufferRange)(unsigned int, intptr_t, intptr_t, unsigned int);
+    extern unsigned char (CAPTURE_APIENTRY *glad_glUnmapBuffer)(unsigned int);
+    extern void (CAPTURE_APIENTRY *glad_glReadPixels)(int, int, int, int, unsigned int, unsigned int, void*);
+
+    unsigned char* rlReadScreenPixels(int width, int height);
+}
+
+// Captures presented frames without stalling the render thread. Reads go into a ring of pixel buffer objects
+// and are mapped two frames later, once the GPU is done with them; PNG and y4m encoding happen on a worker
+// thread. Frames are dropped rather than waited for when the worker or the disk falls behind.
+class FrameCapture {
+    private:
+        enum Kind : uint8_t { Screenshot, Record, StopRecording };
+
+        struct Job {
+            Kind kind = Screenshot;
+            int buffer = -1;
+            bool flipped = false;
+        };
+
+        struct Slot {
+            unsigned int pbo = 0;
+            uint64_t frame = 0;
+            bool busy = false, screenshot = false, record = false;
+        };
+
+        static constexpr unsigned int pixelPackBuffer = 0x88EB, streamRead = 0x88E1, mapRead = 0x0001;
+        static constexpr unsigned int rgba = 0x1908, unsignedByte = 0x1401;
+        static constexpr int latency = 2, slotCount = latency + 1, bufferCount = 8;
+
+        const int width, height, frameRate;
+        const size_t frameBytes;
+        bool usePbo;
+
+        Slot slots[slotCount];
+        std::vector<std::vector<uint8_t>> buffers;
+        SpscQueue<Job> jobs { bufferCount + 4 };
+        SpscQueue<int> available { bufferCount };
+
+        uint64_t frame = 0, dropped = 0;
+        bool screenshotRequested = false, recording = false;
+
+        // The worker sleeps on `wake` while there is nothing to write; producers touch `lock` after queueing so the
+        // signal can't slip in between its check and its wait.
+        std::thread worker;
+        std::mutex lock;
+        std::condition_variable wake;
+        std::atomic<bool> running { true };
+        std::atomic<uint64_t> written { 0 };
+        std::FILE* video = nullptr;
+        std::vector<uint8_t> planes;
+
+        static std::string Timestamped(const char* prefix, const char* extension) {
+            auto now = std::chrono::system_clock::now();
+            std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+            int milliseconds = (int) (std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+
+            char stamp[32], name[96];
+            std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&seconds));
+            std::snprintf(name, sizeof(name), "%s_%s-%03d.%s", prefix, stamp, milliseconds, extension);
+            return name;
+        }
+
+        void Wake() {
+            { std::lock_guard<std::mutex> guard(lock); }
+            wake.notify_one();
+        }
+
+        void Hand(Kind kind, int buffer, bool flipped) {
+            Job job;
+            job.kind = kind, job.buffer = buffer, job.flipped = flipped;
+
+            // Frame jobs always fit since there are fewer buffers than queue slots; only a stop can wait here.
+            while (!jobs.TryPush(job)) std::this_thread::yield();
+            Wake();
+        }
+
+        // Copies one finished read out of the ring and queues it for every consumer that asked for it.
+        void Deliver(const uint8_t* pixels, bool flipped, bool screenshot, bool record) {
+            for (int pass = 0; pass < 2; pass++) {
+                if (!(pass == 0 ? screenshot : record)) continue;
+
+                int buffer;
+                if (!available.TryPop(buffer)) { dropped++; continue; }
+
+                std::memcpy(buffers[buffer].data(), pixels, frameBytes);
+                Hand(pass == 0 ? Screenshot : Record, buffer, flipped);
+            }
+        }
+
+        void Resolve(Slot& slot) {
+            glad_glBindBuffer(pixelPackBuffer, slot.pbo);
+            const uint8_t* pixels = (const uint8_t*) glad_glMapBufferRange(pixelPackBuffer, 0, (intptr_t) frameBytes, mapRead);
+
+            if (pixels) {
+                Deliver(pixels, false, slot.screenshot, slot.record);
+                glad_glUnmapBuffer(pixelPackBuffer);
+            } else {
+                dropped++;
+            }
+
+            glad_glBindBuffer(pixelPackBuffer, 0);
+            slot.busy = false;
+        }
+
+        void WriteScreenshot(const uint8_t* pixels, bool flipped) {
+            Image image = { (void*) pixels, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+            std::vector<uint8_t> upright;
+
+            if (!flipped) {
+                upright.resize(frameBytes);
+                for (int y = 0; y < height; y++)
+                    std::memcpy(&upright[(size_t) y * width * 4], &pixels[(size_t) (height - 1 - y) * width * 4], (size_t) width * 4);
+                image.data = upright.data();
+            }
+
+            ExportImage(image, Timestamped("screenshot", "png").c_str());
+        }
+
+        // y4m with full range BT.601 4:2:0, the format players and encoders accept without options.
+        void WriteVideoFrame(const uint8_t* pixels, bool flipped) {
+            if (!video) {
+                video = std::fopen(Timestamped("capture", "y4m").c_str(), "wb");
+                if (!video) return;
+                std::fprintf(video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width & ~1, height & ~1, std::max(1, frameRate));
+            }
+
+            const int w = width & ~1, h = height & ~1;
+            planes.resize((size_t) w * h * 3 / 2);
+            uint8_t* luma = planes.data();
+            uint8_t* cb = luma + (size_t) w * h;
+            uint8_t* cr = cb + (size_t) w * h / 4;
+
+            auto row = [&](int y) { return &pixels[(size_t) (flipped ? y : height - 1 - y) * width * 4]; };
+
+            for (int y = 0; y < h; y += 2) {
+                const uint8_t* top = row(y);
+                const uint8_t* bottom = row(y + 1);
+
+                for (int x = 0; x < w; x += 2) {
+                    int r = 0, g = 0, b = 0;
+
+                    for (const uint8_t* p : { top + x * 4, top + x * 4 + 4, bottom + x * 4, bottom + x * 4 + 4 }) {
+                        r += p[0], g += p[1], b += p[2];
+                    }
+
+                    for (int i = 0; i < 2; i++) {
+                        const uint8_t* t = top + (x + i) * 4;
+                        const uint8_t* u = bottom + (x + i) * 4;
+                        luma[(size_t) y * w + x + i] = (uint8_t) ((77 * t[0] + 150 * t[1] + 29 * t[2] + 128) >> 8);
+                        luma[(size_t) (y + 1) * w + x + i] = (uint8_t) ((77 * u[0] + 150 * u[1] + 29 * u[2] + 128) >> 8);
+                    }
+
+                    cb[(size_t) (y / 2) * (w / 2) + x / 2] = (uint8_t) std::min(255, std::max(0, (-43 * r - 85 * g + 128 * b + 512 * 256 + 512) >> 10));
+                    cr[(size_t) (y / 2) * (w / 2) + x / 2] = (uint8_t) std::min(255, std::max(0, (128 * r - 107 * g - 21 * b + 512 * 256 + 512) >> 10));
+                }
+            }
+
+            std::fputs("FRAME\n", video);
+            std::fwrite(planes.data(), 1, planes.size(), video);
+        }
+
+        void Work() {
+            while (true) {
+                Job job;
+
+                if (!jobs.TryPop(job)) {
+                    if (!running.load(std::memory_order_acquire) && jobs.Size() == 0) break;
+
+                    std::unique_lock<std::mutex> guard(lock);
+                    wake.wait(guard, [&] { return jobs.Size() != 0 || !running.load(std::memory_order_acquire); });
+                    continue;
+                }
+
+                if (job.kind == StopRecording) {
+                    if (video) std::fclose(video), video = nullptr;
+                    continue;
+                }
+
+                if (job.kind == Screenshot) WriteScreenshot(buffers[job.buffer].data(), job.flipped);
+                else WriteVideoFrame(buffers[job.buffer].data(), job.flipped);
+
+                written.fetch_add(1, std::memory_order_relaxed);
+                while (!available.TryPush(job.buffer)) std::this_thread::yield();
+            }
+
+            if (video) std::fclose(video), video = nullptr;
+        }
+
+    public:
+        // Needs a current GL context. Falls back to synchronous reads when buffer objects are unavailable.
+        FrameCapture(int width, int height, int frameRate) : width(width), height(height), frameRate(frameRate), frameBytes((size_t) width * height * 4) {
+            usePbo = glad_glGenBuffers && glad_glBindBuffer && glad_glBufferData && glad_glMapBufferRange && glad_glUnmapBuffer && glad_glReadPixels;
+
+            if (usePbo) {
+                for (Slot& slot : slots) {
+                    glad_glGenBuffers(1, &slot.pbo);
+                    glad_glBindBuffer(pixelPackBuffer, slot.pbo);
+                    glad_glBufferData(pixelPackBuffer, (intptr_t) frameBytes, nullptr, streamRead);
+                }
+
+                glad_glBindBuffer(pixelPackBuffer, 0);
+            }
+
+            buffers.resize(bufferCount);
+            for (int i = 0; i < bufferCount; i++) buffers[i].resize(frameBytes), available.TryPush(i);
+
+            worker = std::thread(&FrameCapture::Work, this);
+        }
+
+        ~FrameCapture() {
+            if (recording) SetRecording(false);
+            running.store(false, std::memory_order_release);
+            Wake();
+            worker.join();
+
+            if (usePbo && glad_glDeleteBuffers)
+                for (Slot& slot : slots) glad_glDeleteBuffers(1, &slot.pbo);
+        }
+
+        // Saves the next presented frame as a timestamped PNG.
+        void RequestScreenshot() {
+            screenshotRequested = true;
+        }
+
+        // Streams every presented frame to a timestamped y4m file until switched off.
+        void SetRecording(bool enabled) {
+            if (recording && !enabled) {
+                for (Slot& slot : slots) slot.record = false;
+                Hand(StopRecording, -1, false);
+            }
+
+            recording = enabled;
+        }
+
+        bool Recording() const { return recording; }
+        uint64_t Dropped() const { return dropped; }
+        uint64_t Written() const { return written.load(std::memory_order_relaxed); }
+        int64_t GpuBytes() const { return usePbo ? (int64_t) slotCount * (int64_t) frameBytes : 0; }
+
+        // Call with the finished frame in the back buffer, right before it is swapped.
+        void Frame() {
+            frame++;
+
+            if (usePbo) {
+                for (Slot& slot : slots)
+                    if (slot.busy && frame - slot.frame >= latency) Resolve(slot);
+            }
+
+            if (!screenshotRequested && !recording) return;
+
+            if (!usePbo) {
+                unsigned char* pixels = rlReadScreenPixels(width, height);
+                Deliver(pixels, true, screenshotRequested, recording);
+                MemFree(pixels);
+                screenshotRequested = false;
+                return;
+            }
+
+            Slot* target = nullptr;
+            for (Slot& slot : slots)
+                if (!slot.busy) { target = &slot; break; }
+
+            if (!target) { dropped++; return; }
+
+            glad_glBindBuffer(pixelPackBuffer, target->pbo);
+            glad_glReadPixels(0, 0, width, height, rgba, unsignedByte, nullptr);
+            glad_glBindBuffer(pixelPackBuffer, 0);
+
+            target->busy = true, target->frame = frame;
+            target->screenshot = screenshotRequested, target->record = recording;
+            screenshotRequested = false;
+        }
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include <raylib/raylib.h>
+
+// Paces frames by delaying the input poll instead of the present: after a frame is swapped the pacer sleeps
+// until just before the next deadline minus the predicted poll-to-present time, then polls input so the
+// simulation runs on the freshest state. Coarse OS sleeps are topped up with a spin for the final stretch.
+class FramePacer {
+    private:
+        using Clock = std::chrono::high_resolution_clock;
+
+        Clock::time_point latch, previousLatch, target;
+        double period = 1.0 / 60.0, frameTime = 0.0;
+        double work = 0.0, margin = 0.0005, overshoot = 0.001;
+        double latency = 0.0, slept = 0.0, spun = 0.0;
+        bool presented = false;
+
+        static double Seconds(Clock::duration duration) {
+            return std::chrono::duration<double>(duration).count();
+        }
+
+        void WaitUntil(Clock::time_point deadline) {
+            Clock::time_point begin = Clock::now();
+
+            while (true) {
+                double remaining = Seconds(deadline - Clock::now());
+                if (remaining <= overshoot * 1.5) break;
+
+                Clock::time_point before = Clock::now();
+                double request = remaining - overshoot * 1.5;
+                std::this_thread::sleep_for(std::chrono::duration<double>(request));
+
+                double late = Seconds(Clock::now() - before) - request;
+                overshoot = std::max(0.0002, overshoot + (std::max(0.0, late) - overshoot) * (late > overshoot ? 0.5 : 0.05));
+            }
+
+            Clock::time_point spinning = Clock::now();
+            while (Clock::now() < deadline) std::this_thread::yield();
+
+            slept = Seconds(spinning - begin), spun = Seconds(Clock::now() - spinning);
+        }
+
+    public:
+        FramePacer() {
+            latch = previousLatch = target = Clock::now();
+        }
+
+        // A rate of zero or less disables waiting; frames then run back to back.
+        void SetRate(int framesPerSecond) {
+            period = framesPerSecond > 0 ? 1.0 / framesPerSecond : 0.0;
+        }
+
+        // Waits for the next frame slot, then polls input. Call once at the start of a frame.
+        void Latch() {
+            if (presented && period > 0.0) {
+                double lead = std::min(period, work + margin);
+                WaitUntil(target + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period - lead)));
+            } else {
+                slept = spun = 0.0;
+            }
+
+            PollInputEvents();
+            previousLatch = latch, latch = Clock::now();
+            frameTime = std::min(0.25, Seconds(latch - previousLatch));
+        }
+
+        // Call right after the back buffer has been swapped. Deadlines advance by whole periods so pacing
+        // does not drift; a frame that lands more than a period late resynchronises the timeline.
+        void Presented() {
+            Clock::time_point now = Clock::now();
+            Clock::duration step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+            double used = Seconds(now - latch);
+
+            if (presented && period > 0.0) {
+                target += step;
+
+                if (now > target) margin = std::min(period * 0.5, margin * 2.0);
+                else margin = std::max(0.0005, margin * 0.99);
+
+                if (now > target + step) target = now;
+            } else {
+                target = now;
+            }
+
+            work = presented ? work + (used - work) * (used > work ? 0.25 : 0.05) : used;
+            latency = used, presented = true;
+        }
+
+        float FrameTime() const { return (float) frameTime; }
+        int Fps() const { return frameTime > 0.0 ? (int) (1.0 / frameTime + 0.5) : 0; }
+
+        double LatchToPresent() const { return latency * 1000.0; }
+        double SleepTime() const { return slept * 1000.0; }
+        double SpinTime() const { return spun * 1000.0; }
+
+        // Input arrives uniformly between two polls, so on average it waits half a frame before being latched.
+        double InputToPhoton() const { return (latency + std::max(frameTime, period) * 0.5) * 1000.0; }
+};
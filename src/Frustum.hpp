@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cmath>
+
+#include <raylib/raylib.h>
+
+// View frustum of a perspective Camera3D as six inward-facing planes, matching the projection BeginMode3D builds.
+class Frustum {
+    private:
+        Vector3 origin, normals[6];
+        float offsets[6];
+
+        static Vector3 Add(Vector3 a, Vector3 b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+        static Vector3 Subtract(Vector3 a, Vector3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+        static Vector3 Scale(Vector3 a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+        static float Dot(Vector3 a, Vector3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+        static Vector3 Cross(Vector3 a, Vector3 b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+        static Vector3 Normalize(Vector3 a) {
+            float length = std::sqrt(Dot(a, a));
+            return length > 0.0f ? Scale(a, 1.0f / length) : a;
+        }
+
+    public:
+        Frustum(const Camera3D& camera, float aspect, float near, float far) : origin(camera.position) {
+            Vector3 forward = Normalize(Subtract(camera.target, camera.position));
+            Vector3 right = Normalize(Cross(forward, camera.up));
+            Vector3 up = Cross(right, forward);
+
+            float tanVertical = std::tan(camera.fovy * 0.5f * 3.14159265f / 180.0f), tanHorizontal = tanVertical * aspect;
+
+            normals[0] = forward, offsets[0] = -near;
+            normals[1] = Scale(forward, -1.0f), offsets[1] = far;
+            normals[2] = Add(right, Scale(forward, tanHorizontal)), offsets[2] = 0.0f;
+            normals[3] = Add(Scale(right, -1.0f), Scale(forward, tanHorizontal)), offsets[3] = 0.0f;
+            normals[4] = Add(up, Scale(forward, tanVertical)), offsets[4] = 0.0f;
+            normals[5] = Add(Scale(up, -1.0f), Scale(forward, tanVertical)), offsets[5] = 0.0f;
+        }
+
+        bool Contains(Vector3 center, Vector3 halfSize) const {
+            Vector3 relative = Subtract(center, origin);
+
+            for (int i = 0; i < 6; i++) {
+                const Vector3& n = normals[i];
+                float radius = halfSize.x * std::fabs(n.x) + halfSize.y * std::fabs(n.y) + halfSize.z * std::fabs(n.z);
+                if (Dot(n, relative) + offsets[i] + radius < 0.0f) return false;
+            }
+
+            return true;
+        }
+};
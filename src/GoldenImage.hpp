@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include <raylib/raylib.h>
+
+struct ImageDifference {
+    double mean = 0.0, outlierRate = 0.0;
+    float maximum = 0.0f;
+    bool comparable = false;
+};
+
+// Compares two RGBA8 images the way a viewer would: both are box blurred over 3x3 to ignore single pixel
+// aliasing, then each pixel is scored by luma difference plus half the chroma difference (0 - 255).
+// Both images must already be PIXELFORMAT_UNCOMPRESSED_R8G8B8A8.
+inline ImageDifference CompareImages(const Image& expected, const Image& actual, float threshold) {
+    ImageDifference result;
+    if (expected.width != actual.width || expected.height != actual.height) return result;
+    if (expected.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 || actual.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) return result;
+
+    const int width = expected.width, height = expected.height;
+    auto luma = [&](const uint8_t* pixels, std::vector<float>& y, std::vector<float>& cb, std::vector<float>& cr) {
+        y.resize((size_t) width * height), cb.resize(y.size()), cr.resize(y.size());
+
+        for (size_t i = 0; i < y.size(); i++) {
+            float r = pixels[i * 4], g = pixels[i * 4 + 1], b = pixels[i * 4 + 2];
+            y[i] = 0.299f * r + 0.587f * g + 0.114f * b;
+            cb[i] = b - y[i], cr[i] = r - y[i];
+        }
+    };
+
+    auto blur = [&](std::vector<float>& channel) {
+        std::vector<float> copy = channel;
+
+        for (int py = 0; py < height; py++) {
+            for (int px = 0; px < width; px++) {
+                float sum = 0.0f; int count = 0;
+
+                for (int oy = std::max(0, py - 1); oy <= std::min(height - 1, py + 1); oy++)
+                    for (int ox = std::max(0, px - 1); ox <= std::min(width - 1, px + 1); ox++)
+                        sum += copy[(size_t) oy * width + ox], count++;
+
+                channel[(size_t) py * width + px] = sum / count;
+            }
+        }
+    };
+
+    std::vector<float> ey, ecb, ecr, ay, acb, acr;
+    luma((const uint8_t*) expected.data, ey, ecb, ecr);
+    luma((const uint8_t*) actual.data, ay, acb, acr);
+    for (std::vector<float>* channel : { &ey, &ecb, &ecr, &ay, &acb, &acr }) blur(*channel);
+
+    size_t outliers = 0;
+    double total = 0.0;
+
+    for (size_t i = 0; i < ey.size(); i++) {
+        float difference = std::fabs(ey[i] - ay[i]) + 0.5f * (std::fabs(ecb[i] - acb[i]) + std::fabs(ecr[i] - acr[i]));
+        total += difference, result.maximum = std::max(result.maximum, difference);
+        if (difference > threshold) outliers++;
+    }
+
+    result.mean = total / ey.size();
+    result.outlierRate = (double) outliers / ey.size();
+    result.comparable = true;
+    return result;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_WIN32)
+    #define TIMER_APIENTRY __stdcall
+#else
+    #define TIMER_APIENTRY
+#endif
+
+// Timer queries are core since GL 3.3, which raylib targets, but only reachable through its loader's pointers.
+extern "C" {
+    extern void (TIMER_APIENTRY *glad_glGenQueries)(int, unsigned int*);
+    extern void (TIMER_APIENTRY *glad_glDeleteQueries)(int, const unsigned int*);
+    extern void (TIMER_APIENTRY *glad_glBeginQuery)(unsigned int, unsigned int);
+    extern void (TIMER_APIENTRY *glad_glEndQuery)(unsigned int);
+    extern void (TIMER_APIENTRY *glad_glGetQueryObjectiv)(unsigned int, unsigned int, int*);
+    extern void (TIMER_APIENTRY *glad_glGetQueryObjectui64v)(unsigned int, unsigned int, uint64_t*);
+}
+
+// GPU time of the commands between Begin() and End(), from GL_TIME_ELAPSED queries in a small ring. A result
+// is only read once the GPU reports it available, a few frames later, so timing never stalls the pipeline.
+// Only one timer can be running at a time. Without GL timer queries the timer reads zero.
+class GpuTimer {
+    private:
+        static constexpr unsigned int timeElapsed = 0x88BF, queryResult = 0x8866, queryResultAvailable = 0x8867;
+        static constexpr int slots = 4;
+
+        unsigned int queries[slots] = {};
+        bool pending[slots] = {};
+        int next = 0;
+        bool created = false, running = false;
+        double milliseconds = 0.0;
+
+        static bool Supported() {
+            return glad_glGenQueries && glad_glDeleteQueries && glad_glBeginQuery && glad_glEndQuery && glad_glGetQueryObjectiv && glad_glGetQueryObjectui64v;
+        }
+
+        void Collect() {
+            // Oldest first, so the newest available result is the one kept.
+            for (int k = 0; k < slots; k++) {
+                const int i = (next + k) % slots;
+                int available = 0;
+                if (!pending[i]) continue;
+
+                glad_glGetQueryObjectiv(queries[i], queryResultAvailable, &available);
+                if (!available) continue;
+
+                uint64_t nanoseconds = 0;
+                glad_glGetQueryObjectui64v(queries[i], queryResult, &nanoseconds);
+                milliseconds = nanoseconds / 1e6, pending[i] = false;
+            }
+        }
+
+    public:
+        void Begin() {
+            if (!Supported()) return;
+            if (!created) glad_glGenQueries(slots, queries), created = true;
+
+            Collect();
+            if (pending[next]) return;
+
+            glad_glBeginQuery(timeElapsed, queries[next]);
+            running = true;
+        }
+
+        void End() {
+            if (!running) return;
+            glad_glEndQuery(timeElapsed);
+            pending[next] = true, running = false;
+            next = (next + 1) % slots;
+        }
+
+        // The most recent result, a few frames behind the latest Begin() / End() pair.
+        double Milliseconds() const {
+            return milliseconds;
+        }
+
+        void Release() {
+            if (created) glad_glDeleteQueries(slots, queries);
+            created = false;
+            for (bool& slot : pending) slot = false;
+        }
+};
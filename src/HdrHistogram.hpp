@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// Histogram of non-negative integer values, exact below 256 and within 1/128 of the value above it, up to 2^36.
+// Values are grouped by their highest set bit and then linearly by the next seven bits, so recording is a bit scan,
+// a shift and an increment. Counts sit in a fixed array, so the histogram never allocates after construction.
+class HdrHistogram {
+    public:
+        static constexpr int subBits = 8, sub = 1 << subBits, half = sub / 2, maxBits = 36;
+        static constexpr int buckets = sub + (maxBits - subBits) * half;
+
+    private:
+        uint32_t counts[buckets];
+        uint64_t total, minimum, maximum, sum;
+
+        static int Log2(uint64_t value) {
+#if defined(__GNUC__)
+            return 63 - __builtin_clzll(value);
+#else
+            int bits = 0;
+            while (value >>= 1) bits++;
+            return bits;
+#endif
+        }
+
+    public:
+        HdrHistogram() {
+            Reset();
+        }
+
+        static int Index(uint64_t value) {
+            value = std::min(value, (uint64_t(1) << maxBits) - 1);
+            if (value < (uint64_t) sub) return (int) value;
+
+            const int exponent = Log2(value), shift = exponent - subBits + 1;
+            return sub + (exponent - subBits) * half + (int) ((value >> shift) - half);
+        }
+
+        // Smallest value that lands in bucket `index`.
+        static uint64_t Lowest(int index) {
+            if (index < sub) return (uint64_t) index;
+
+            const int exponent = (index - sub) / half + subBits, shift = exponent - subBits + 1;
+            return (uint64_t) ((index - sub) % half + half) << shift;
+        }
+
+        static uint64_t Highest(int index) {
+            return index + 1 < buckets ? Lowest(index + 1) - 1 : (uint64_t(1) << maxBits) - 1;
+        }
+
+        void Record(uint64_t value) {
+            counts[Index(value)]++;
+            total++, sum += value;
+            minimum = std::min(minimum, value), maximum = std::max(maximum, value);
+        }
+
+        void Reset() {
+            std::memset(counts, 0, sizeof(counts));
+            total = sum = maximum = 0, minimum = ~uint64_t(0);
+        }
+
+        // Adds one bucket's worth of values, as read back from a log. Values are taken at the bucket's midpoint.
+        void Add(int index, uint32_t count) {
+            if (index < 0 || index >= buckets || count == 0) return;
+            const uint64_t value = (Lowest(index) + Highest(index)) / 2;
+            counts[index] += count;
+            total += count, sum += value * count;
+            minimum = std::min(minimum, Lowest(index)), maximum = std::max(maximum, Highest(index));
+        }
+
+        void Merge(const HdrHistogram& other) {
+            for (int i = 0; i < buckets; i++) counts[i] += other.counts[i];
+            total += other.total, sum += other.sum;
+            minimum = std::min(minimum, other.minimum), maximum = std::max(maximum, other.maximum);
+        }
+
+        // The value at or below which `fraction` of the recorded values fall, reported as the bucket's upper edge
+        // and capped at the largest value seen.
+        uint64_t Percentile(double fraction) const {
+            if (total == 0) return 0;
+            const uint64_t target = std::max<uint64_t>(1, (uint64_t) (fraction * total + 0.5));
+            uint64_t seen = 0;
+
+            for (int i = 0; i < buckets; i++)
+                if ((seen += counts[i]) >= target) return std::min(Highest(i), maximum);
+
+            return maximum;
+        }
+
+        uint32_t Count(int index) const { return counts[index]; }
+        uint64_t Total() const { return total; }
+        uint64_t Min() const { return total ? minimum : 0; }
+        uint64_t Max() const { return maximum; }
+        uint64_t Sum() const { return sum; }
+        double Mean() const { return total ? (double) sum / total : 0.0; }
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+class JobPool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake, done;
+        std::function<void(size_t, size_t)> job;
+        size_t count = 0, chunk = 0, next = 0, pending = 0;
+        uint64_t generation = 0;
+        bool stopping = false;
+
+        bool Claim(size_t& begin, size_t& end) {
+            if (next >= count) return false;
+            begin = next, end = std::min(count, next + chunk), next = end;
+            return true;
+        }
+
+        void Work(std::unique_lock<std::mutex>& lock) {
+            size_t begin, end;
+
+            while (Claim(begin, end)) {
+                lock.unlock();
+                job(begin, end);
+                lock.lock();
+                if ((pending -= end - begin) == 0) done.notify_all();
+            }
+        }
+
+        void Worker() {
+            std::unique_lock<std::mutex> lock(mutex);
+            uint64_t seen = generation;
+
+            while (true) {
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                Work(lock);
+            }
+        }
+
+    public:
+        JobPool(size_t threads = 0) {
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+            for (size_t i = 1; i < threads; i++)
+                workers.emplace_back(&JobPool::Worker, this);
+        }
+
+        ~JobPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            } wake.notify_all();
+
+            for (std::thread& worker : workers)
+                worker.join();
+        }
+
+        size_t Size() const {
+            return workers.size() + 1;
+        }
+
+        // Splits [0, total) into chunks of `grain` and runs them across the pool, the calling thread included.
+        void ParallelFor(size_t total, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+            if (total == 0) return;
+            std::unique_lock<std::mutex> lock(mutex);
+            job = fn, count = total, chunk = std::max<size_t>(1, grain), next = 0, pending = total;
+            generation++;
+            wake.notify_all();
+            Work(lock);
+            done.wait(lock, [&] { return pending == 0; });
+            job = nullptr;
+        }
+};
@@ -4,34 +4,48 @@
 #include <ctime>
 #include <string>
 #include <chrono>
+#include <cmath>
+#include <memory>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <mutex>
 
 #include <raylib/raylib.h>
 
+#include "JobPool.hpp"
+#include "Profiler.hpp"
+#include "SoftwarePostProcess.hpp"
+#include "GoldenImage.hpp"
+#include "Microbenchmark.hpp"
+#include "FramePacer.hpp"
+#include "TripleBuffer.hpp"
+#include "WorldSnapshot.hpp"
+#include "TrackGenerator.hpp"
+#include "Solvability.hpp"
+#include "Frustum.hpp"
+#include "DrawQueue.hpp"
+#include "FrameCapture.hpp"
+#include "RenderGraph.hpp"
+#include "Allocations.hpp"
+#include "MemoryBudget.hpp"
+#include "ProcessMemory.hpp"
+#include "Components.hpp"
+#include "Autopilot.hpp"
+#include "RewindBuffer.hpp"
+#include "SeedSearch.hpp"
+#include "Telemetry.hpp"
+#include "Spectator.hpp"
+#include "Spectrum.hpp"
+
+// rlgl.h is not shipped next to the prebuilt library; flushing the batch is the only rlgl call needed.
+extern "C" void rlDrawRenderBatchActive(void);
+
 float lerp(float a, float b, float t) {
     return a + (b - a) * t;
 }
 
-class Entity {
-    public:
-        Vector3 position, size;
-        Color color;
-
-        Entity(Vector3 position, Vector3 size, Color color) : position(position), size(size), color(color) {}
-
-        void Draw() const {
-            DrawCube(this->position, this->size.x, this->size.y, this->size.z, this->color);
-        }
-
-        bool Collide(Entity* other) const {
-            return CheckCollisionBoxes({
-                { this->position.x - this->size.x / 2, this->position.y - this->size.y / 2, this->position.z - this->size.z / 2 },
-                { this->position.x + this->size.x / 2, this->position.y + this->size.y / 2, this->position.z + this->size.z / 2 } }, {
-                { other->position.x - other->size.x / 2, other->position.y - other->size.y / 2, other->position.z - other->size.z / 2 },
-                { other->position.x + other->size.x / 2, other->position.y + other->size.y / 2, other->position.z + other->size.z / 2 }
-            });
-        }
-};
-
 class App {
     private:
         Camera3D camera = {
@@ -42,261 +56,2051 @@ class App {
         };
 
         Font font;
-        Entity* entity;
-        std::vector<Entity*> obstacles;
+        GameWorld world;
         uint32_t width, height;
         Sound music;
 
+        // Background flashes, bloom and obstacle glow follow the music when it can be analysed; headless runs are
+        // measured and compared frame for frame, so they keep the fixed beat.
+        std::unique_ptr<Spectrum> spectrum;
+        AudioBands audio;
+        uint32_t seenOnsets = 0;
+        int bloomIntensityLocation = -1;
+        float bloomIntensity = 1.0f, appliedBloomIntensity = 1.0f;
+
+        RenderTexture2D firstTarget, cachedFrame, textLayer;
+        Shader bloomShader, crtShader;
+        RenderGraph postGraph;
+        RenderGraph::Handle postOutput = -1;
+        bool useBloom = true, useCrt = true;
+        Profiler profiler;
+        MemoryBudget memory;
+        FramePacer pacer;
+
+        std::unique_ptr<JobPool> jobPool;
+        std::unique_ptr<FrameCapture> capture;
+        bool recordOnStart = false;
+        std::unique_ptr<Telemetry> telemetry;
+        std::string telemetryDirectory;
+        double postTime = 0.0;
+        std::unique_ptr<SpectatorServer> spectators;
+        uint16_t broadcastPort = 0;
+        uint32_t broadcastAddress = Endpoint::loopback;
+        std::unique_ptr<SoftwarePostProcess> softwarePost;
+        std::vector<uint8_t> softwareFrame;
+        Texture2D softwareTarget;
+        bool useSoftwarePost = false;
+
+        std::chrono::high_resolution_clock::time_point start;
+        Color backgroundColor = VIOLET;
+        bool introState = true, deathState = false, startState = false;
+
+        unsigned seed = (unsigned) time(NULL);
+        int windowWidth = 0, windowHeight = 0, frameRate = 0;
+        bool headless = false;
+        float frameTime = 0.0f, cullDistance = 1000.0f;
+
+        // Menu, game over and pause screens are redrawn only when what they show changes, and the pacer drops
+        // to a lower rate on them. cachedKey is zero whenever the current frame is not cached. The text of the menu
+        // and game over screens is kept in textLayer under textKey, so a flashing background only costs a
+        // clear, one quad and the post-processing.
+        bool powerSaver = true;
+        int displayRate = 60, idleFrameRate = 30, pausedFrameRate = 15;
+        uint64_t cachedKey = 0, staticFrames = 0, textKey = 0, textFrames = 0;
+
         const float bpm = 110.0f;
-        float speed, score, timeScale, targetX, sinceBeat = 0.0f;
+        const float tickTime = 1.0f / 240.0f, maxTicksPerFrame = 60.0f;
+        float speed, timeScale, targetX, sinceBeat = 0.0f, accumulator = 0.0f;
+        Vector3 previousPosition = { 0.0f, 0.0f, 0.0f };
+        Camera3D previousCamera = camera;
         bool dead = false, started = false, hueState, paused;
-        int hue, maxObstacles, passBeat = 8 * 4 - 1;
+        int hue, maxObstacles, passBeat = 8 * 4 - 1, runs = 0;
+
+        static constexpr uint8_t holdLeft = 1, holdRight = 2, holdSlow = 4;
+
+        TripleBuffer<WorldSnapshot> snapshots;
+        DrawQueue drawQueue;
+        std::unique_ptr<TrackGenerator> track;
+        std::thread simulation;
+        std::atomic<bool> simulating { false }, startRequested { false }, pauseRequested { false };
+        std::atomic<bool> demoRequested { false }, menuRequested { false };
+        std::atomic<uint8_t> heldKeys { 0 };
+        uint64_t published = 0, lastSequence = 0, tornSnapshots = 0;
+        double tickClock = 0.0;
+        int playedRuns = 0;
+
+        // The planner drives every run when autopilot is set, and demo runs started from an idle menu.
+        Autopilot planner;
+        bool autopilot = false, demo = false;
+        double attractDelay = 0.0, idleSince = 0.0;
+
+        // Distance is kept in double; positions stay near zero because the world is shifted back by `origin`.
+        double score = 0.0, origin = 0.0;
+        float rebaseDistance = 1024.0f;
+        bool ghost = false;
+        uint64_t collisions = 0;
+
+        // Practice mode records every tick so R can take the run back rewindStep seconds at a time.
+        std::unique_ptr<RewindBuffer> rewind;
+        std::vector<RewindObstacle> rewindObstacles;
+        std::atomic<int> rewindRequested { 0 };
+        double practiceSeconds = 0.0, rewindStep = 5.0;
+        bool soundPaused = false;
+
+        static double Now() {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
 
         void DrawTextCentered(const char* text, int offset, int size, Color color) {
             DrawText(text, width / 2 - MeasureText(text, size) / 2, height / 2 - size / 2 + offset, size, color);
         }
 
+        Location& Player() {
+            return world.Get<Players>().Get<Location>(0);
+        }
+
     public:
-        App() {}
+        App() {
+            world.Get<Players>().Add({ { 0.0f, 0.0f, 0.0f } }, { { 2.0f, 2.0f, 2.0f } }, { RAYWHITE });
+        }
+
         ~App() {}
 
+        void SetSoftwarePost(bool enabled) {
+            useSoftwarePost = enabled;
+        }
+
+        void SetSeed(unsigned value) {
+            seed = value;
+        }
+
+        void SetResolution(int width, int height) {
+            windowWidth = width, windowHeight = height;
+        }
+
+        void SetHeadless(bool enabled) {
+            headless = enabled;
+        }
+
+        // Only changes how often frames are drawn; the simulation always ticks at 1 / tickTime.
+        void SetFrameRate(int value) {
+            frameRate = value;
+        }
+
+        void SetPowerSaver(bool enabled) {
+            powerSaver = enabled;
+        }
+
+        void SetRecording(bool enabled) {
+            recordOnStart = enabled;
+        }
+
+        // Logs frame and stage time histograms and hitches under `directory`; empty turns telemetry off.
+        void SetTelemetry(const std::string& directory) {
+            telemetryDirectory = directory;
+        }
+
+        // Streams the game to spectators that join on `port`; zero turns broadcasting off.
+        void SetBroadcast(uint16_t port) {
+            broadcastPort = port;
+        }
+
+        // Only local spectators can join unless this names a wider interface, zero being all of them.
+        void SetBroadcastAddress(uint32_t address) {
+            broadcastAddress = address;
+        }
+
+        void SetAutopilot(bool enabled) {
+            autopilot = enabled;
+        }
+
+        // Keeps the last `seconds` of every run for rewinding; zero turns practice mode off.
+        void SetPractice(double seconds) {
+            practiceSeconds = seconds;
+        }
+
+        // Seconds of idling on the menu before a demo run starts; zero, the default, turns the attract mode off.
+        void SetAttractDelay(double seconds) {
+            attractDelay = seconds;
+        }
+
+        void SetPostEffects(bool bloom, bool crt) {
+            useBloom = bloom, useCrt = crt;
+        }
+
+        // Obstacles further than this from the camera are not drawn. raylib's own far plane sits at 1000.
+        void SetCullDistance(float value) {
+            cullDistance = value;
+        }
+
         void ChangeHue() {
-            if (hue >= 360) hueState = false;
-            if (hue <= 0) hueState = true;
-            if (hueState) { hue++; }
-            else { hue--; }
+            TrackGenerator::ChangeHue(hue, hueState);
         }
 
         void Reset() {
-            entity->position = {0.0f, 0.0f, 0.0f};
-            entity->position.x = 0.0f, targetX = 0.0f;
-            camera.position.x = entity->position.x, camera.target.x = camera.position.x, camera.target.y = 10.0f;
-            speed = 0.15f, score = 0.0f, timeScale = 0.0f, sinceBeat = 0.0f;
+            Player().position = {0.0f, 0.0f, 0.0f};
+            Player().position.x = 0.0f, targetX = 0.0f;
+            camera.position.x = Player().position.x, camera.target.x = camera.position.x, camera.target.y = 10.0f;
+            speed = 0.15f, score = 0.0, timeScale = 0.0f;
             paused = false, dead = false, started = false, hueState = true;
-            while ((hue = rand()) > RAND_MAX - (RAND_MAX - 5) % 6);
-            maxObstacles = 20, passBeat = 8 * 4 - 1;
-            PlaySound(music);
+            hue = track->BeginRun();
+            maxObstacles = 20, runs++;
+            accumulator = 0.0f, previousPosition = Player().position, previousCamera = camera;
+            origin = 0.0;
         }
 
-        void Run() {
-            InitWindow(0, 0, "Crawl");
-            srand((unsigned) time(NULL));
+        void StartRun() {
+            Allocations::Scope scope(Allocations::Entities);
+
+            world.Get<Obstacles>().Clear();
+            Reset(), started = true;
+
+            for (int i = 0; i < maxObstacles; i++) {
+                Spawn spawn = track->Next(); hue = spawn.hue;
+                world.Get<Obstacles>().Add({ { spawn.lane, 0.0f, (i + 1) * -10.0f } }, { { 2.0f, 2.0f, 2.0f } }, { spawn.color });
+            }
+
+            if (rewind) rewind->Clear(), Record();
+        }
+
+        void EnableRewind() {
+            Allocations::Scope scope(Allocations::Rewind);
+            if (practiceSeconds > 0.0) rewind = std::make_unique<RewindBuffer>(practiceSeconds, 1.0 / tickTime);
+        }
+
+        void Record() {
+            Allocations::Scope scope(Allocations::Rewind);
+            rewindObstacles.resize(world.Get<Obstacles>().Size());
+
+            RewindObstacle* out = rewindObstacles.data();
+            world.Get<Obstacles>().EachChunk<Location, Tint>([&](size_t count, Location* locations, Tint* tints) {
+                for (size_t i = 0; i < count; i++) *out++ = { locations[i].position, tints[i].color };
+            });
+
+            rewind->Capture({ Player().position, camera, score, origin, speed, timeScale, targetX, hue, track->Cursor(), hueState, dead }, track->Chunk(), rewindObstacles);
+        }
+
+        // Puts the run back `seconds`, or as far as the buffer reaches, and carries on recording from there.
+        bool RewindBy(double seconds) {
+            if (!rewind || rewind->Empty()) return false;
+
+            const uint64_t newest = rewind->Newest(), back = (uint64_t) std::llround(seconds / tickTime);
+            if (!rewind->Restore(newest - std::min(back, newest - rewind->Oldest()))) return false;
+
+            const RewindFrame& frame = rewind->Frame();
+            Player().position = frame.position, camera = frame.camera;
+            score = frame.score, origin = frame.origin;
+            speed = frame.speed, timeScale = frame.timeScale, targetX = frame.targetX;
+            hue = frame.hue, hueState = frame.hueState, dead = frame.dead;
+            track->Rewind(rewind->Chunk(), frame.cursor);
+
+            const RewindObstacle* in = rewind->Obstacles().data();
+            world.Get<Obstacles>().EachChunk<Location, Tint>([&](size_t count, Location* locations, Tint* tints) {
+                for (size_t i = 0; i < count; i++, in++) locations[i].position = in->position, tints[i].color = in->color;
+            });
+
+            previousPosition = Player().position, previousCamera = camera, accumulator = 0.0f;
+            return true;
+        }
+
+        void Init() {
+            if (headless) SetConfigFlags(FLAG_WINDOW_HIDDEN);
+            InitWindow(windowWidth, windowHeight, "Crawl");
 
-            // width = static_cast<uint32_t>(1600.0f / 1920.0f * GetMonitorWidth(0));
-            // height = static_cast<uint32_t>(900.0f / 1080.0f * GetMonitorHeight(0));
+            {
+                Allocations::Scope scope(Allocations::Track);
+                track = std::make_unique<TrackGenerator>(seed);
+            }
+
+            EnableRewind();
+
+            if (windowWidth == 0 || windowHeight == 0) {
+                // width = static_cast<uint32_t>(1600.0f / 1920.0f * GetMonitorWidth(0));
+                // height = static_cast<uint32_t>(900.0f / 1080.0f * GetMonitorHeight(0));
+
+                width = GetMonitorWidth(0);
+                height = GetMonitorHeight(0);
 
-            width = GetMonitorWidth(0);
-            height = GetMonitorHeight(0);
+                displayRate = frameRate > 0 ? frameRate : GetMonitorRefreshRate(0);
+                SetWindowPosition(GetMonitorWidth(0) / 2 - width / 2, GetMonitorHeight(0) / 2 - height / 2);
+                SetWindowSize(width, height);
+                ToggleFullscreen();
+            } else {
+                width = windowWidth;
+                height = windowHeight;
+                displayRate = frameRate > 0 ? frameRate : GetMonitorRefreshRate(0);
+            }
 
-            SetTargetFPS(GetMonitorRefreshRate(0));
-            SetWindowPosition(GetMonitorWidth(0) / 2 - width / 2, GetMonitorHeight(0) / 2 - height / 2);
-            SetWindowSize(width, height);
-            ToggleFullscreen();
+            pacer.SetRate(displayRate);
 
             Image icon = LoadImage("res/icon.png");
             SetWindowIcon(icon);
             UnloadImage(icon);
 
-            RenderTexture2D firstTarget = LoadRenderTexture(width, height);
-            RenderTexture2D secondTarget = LoadRenderTexture(width, height);
-            Shader bloomShader = LoadShader(0, "shaders/bloom.frag");
-            Shader crtShader = LoadShader(0, "shaders/crt.frag");
+            firstTarget = LoadRenderTexture(width, height);
+            cachedFrame = LoadColorTarget(width, height);
+            textLayer = LoadColorTarget(width, height);
+            memory.Track("scene target", MemoryBudget::Gpu, MemoryBudget::TargetBytes(firstTarget));
+            memory.Track("cached frame", MemoryBudget::Gpu, MemoryBudget::TargetBytes(cachedFrame));
+            memory.Track("text layer", MemoryBudget::Gpu, MemoryBudget::TargetBytes(textLayer));
+            memory.Track("default font", MemoryBudget::Gpu, MemoryBudget::TextureBytes(GetFontDefault().texture));
+
+            {
+                Allocations::Scope scope(Allocations::Capture);
+                capture = std::make_unique<FrameCapture>(width, height, displayRate);
+                capture->SetRecording(recordOnStart);
+                memory.Track("capture buffers", MemoryBudget::Gpu, capture->GpuBytes());
+            }
+
+            bloomShader = LoadShader(0, "shaders/bloom.frag");
+            crtShader = LoadShader(0, "shaders/crt.frag");
 
             float size[2] = { (float) width, (float) height };
             SetShaderValue(bloomShader, GetShaderLocation(bloomShader, "size"), size, SHADER_UNIFORM_VEC2);
             SetShaderValue(crtShader, GetShaderLocation(crtShader, "size"), size, SHADER_UNIFORM_VEC2);
+            bloomIntensityLocation = GetShaderLocation(bloomShader, "intensity");
+            BuildPostGraph();
+            memory.Track("post graph targets", MemoryBudget::Gpu, (int64_t) postGraph.Bytes());
+
+            {
+                Allocations::Scope scope(Allocations::PostProcess);
+                jobPool = std::make_unique<JobPool>();
+                softwarePost = std::make_unique<SoftwarePostProcess>(*jobPool, width, height);
+                softwareFrame.resize((size_t) width * height * 4);
+            }
+
+            Image blank = GenImageColor(width, height, BLACK);
+            softwareTarget = LoadTextureFromImage(blank);
+            UnloadImage(blank);
+            memory.Track("software target", MemoryBudget::Gpu, MemoryBudget::TextureBytes(softwareTarget));
 
-            auto start = std::chrono::high_resolution_clock::now();
+            start = std::chrono::high_resolution_clock::now();
 
-            entity = new Entity(
-                {0.0f, 0.0f, 0.0f},
-                {2.0f, 2.0f, 2.0f}, RAYWHITE
-            );
+            if (!telemetryDirectory.empty()) {
+                telemetry = std::make_unique<Telemetry>(telemetryDirectory);
+                telemetry->Start();
+            }
 
-            Color backgroundColor = VIOLET;
-            bool introState = true, deathState = false, startState = false;
+            if (broadcastPort != 0) {
+                spectators = std::make_unique<SpectatorServer>();
+                if (!spectators->Open(broadcastPort, broadcastAddress)) std::printf("could not open spectator port %u\n", (unsigned) broadcastPort), spectators.reset();
+            }
 
             InitAudioDevice();
-            music = LoadSound("res/music_alt.wav"), sinceBeat = 0.0f;
+            if (headless) SetMasterVolume(0.0f);
+            Wave wave = LoadWave("res/music_alt.wav");
+            music = LoadSoundFromWave(wave), sinceBeat = 0.0f;
+            memory.Track("music", MemoryBudget::Audio, MemoryBudget::SoundBytes(music));
+
+            if (!headless && wave.data) {
+                Allocations::Scope scope(Allocations::Audio);
+                spectrum = std::make_unique<Spectrum>(wave);
+                memory.Track("music spectrum", MemoryBudget::Audio, (int64_t) spectrum->Bytes());
+                spectrum->Start();
+            }
+
+            UnloadWave(wave);
             PlaySound(music);
+            if (spectrum) spectrum->Play();
+        }
 
-            while (!WindowShouldClose()) {
-                if (IsSoundPlaying(music))
-                    sinceBeat += GetFrameTime();
+        void Shutdown() {
+            UnloadShader(bloomShader);
+            UnloadShader(crtShader);
+
+            UnloadRenderTexture(firstTarget);
+            postGraph.Release();
+            UnloadRenderTexture(cachedFrame);
+            UnloadRenderTexture(textLayer);
+            capture.reset();
+            telemetry.reset();
+            spectators.reset();
+            UnloadTexture(softwareTarget);
 
-                if (sinceBeat >= 60.0f / bpm) {
-                    sinceBeat = sinceBeat - 60.0f / bpm;
+            softwarePost.reset();
+            jobPool.reset();
+            track.reset();
 
-                    if (passBeat != 0) { passBeat--; }
-                    else {
-                        backgroundColor = (started && dead) ? RED : ((!started && !dead) ? VIOLET : ColorFromHSV(hue, 1, 1));
-                    }
+            spectrum.reset();
+            UnloadSound(music);
+            CloseAudioDevice();
+
+            world.Get<Obstacles>().Clear();
+            CloseWindow();
+        }
+
+        static void DrawTarget(const Texture2D& texture) {
+            DrawTextureRec(texture, { 0, 0, (float) texture.width, (float) -texture.height }, { 0, 0 }, WHITE);
+        }
+
+        // scene -> bloom -> crt -> output. Only the bloom result is transient; the scene needs depth and is kept
+        // for the software path, the output is bound per call.
+        void BuildPostGraph() {
+            RenderGraph::Handle scene = postGraph.Import("scene", &firstTarget);
+            RenderGraph::Handle bloomed = postGraph.Create("bloomed", { (int) width, (int) height });
+            postOutput = postGraph.Import("output", nullptr);
+
+            postGraph.AddPass("bloom", { scene }, bloomed, [this](const std::vector<Texture2D>& inputs) {
+                if (bloomIntensity != appliedBloomIntensity) {
+                    SetShaderValue(bloomShader, bloomIntensityLocation, &bloomIntensity, SHADER_UNIFORM_FLOAT);
+                    appliedBloomIntensity = bloomIntensity;
                 }
 
-                if (deathState != dead || startState != started) {
-                    startState = started, deathState = dead;
-                    backgroundColor = BLACK;
+                BeginShaderMode(bloomShader);
+                DrawTarget(inputs[0]);
+                EndShaderMode();
+            });
+
+            postGraph.AddPass("crt", { bloomed }, postOutput, [this](const std::vector<Texture2D>& inputs) {
+                BeginShaderMode(crtShader);
+                DrawTarget(inputs[0]);
+                EndShaderMode();
+            });
+
+            postGraph.SetEnabled("bloom", useBloom);
+            postGraph.SetEnabled("crt", useCrt);
+            postGraph.Compile();
+        }
+
+        // With a null output the result goes to the screen and drawing is left open for Present().
+        void ShaderPostProcess(RenderTexture2D* output) {
+            postGraph.Bind(postOutput, output);
+            postGraph.Run();
+        }
+
+        void SoftwarePostProcessFrame() {
+            Image scene = LoadImageFromTexture(firstTarget.texture);
+            softwarePost->SetBloomIntensity(bloomIntensity);
+            softwarePost->Process((const uint8_t*) scene.data, softwareFrame.data());
+            UnloadImage(scene);
+            UpdateTexture(softwareTarget, softwareFrame.data());
+        }
+
+        // Draws the last post-processed frame: the software path always leaves it in softwareTarget, the shader
+        // path only keeps it in cachedFrame while the screen is static.
+        void PresentCached() {
+            DrawTarget(useSoftwarePost ? softwareTarget : cachedFrame.texture);
+        }
+
+        // The background fades a little every frame and flashes on the beat, so static screens draw it in steps of
+        // 16 per channel; most frames of a fade then match the one before.
+        static Color Quantised(Color color) {
+            return { (unsigned char) (color.r & 0xF0), (unsigned char) (color.g & 0xF0), (unsigned char) (color.b & 0xF0), color.a };
+        }
+
+        // Everything the text of the menu and game over screens depends on, or zero when it is drawn directly.
+        uint64_t TextKey(const WorldSnapshot& view) const {
+            if (!powerSaver || introState || IsKeyDown(KEY_Q)) return 0;
+            if (view.started && !view.dead) return 0;
+
+            uint64_t key = TrackGenerator::Mix((uint64_t) view.started | (uint64_t) view.dead << 1 | (uint64_t) (view.rewindable > 0.0f) << 2);
+            key = TrackGenerator::Mix(key ^ (uint64_t) (int64_t) view.score);
+            return key | 1;
+        }
+
+        // Everything the menu, game over and pause screens depend on, or zero when the frame has to be drawn.
+        // Besides the scene, the post-processing only reads the bloom intensity, which moves in steps small enough
+        // to key exactly, and the obstacle glow holds still while paused, so an equal key means an equal frame.
+        uint64_t StaticKey(const WorldSnapshot& view) const {
+            if (!powerSaver || introState || IsKeyDown(KEY_Q)) return 0;
+            if (view.started && !view.dead && !view.paused) return 0;
+
+            uint64_t key = TrackGenerator::Mix((uint64_t) view.started | (uint64_t) view.dead << 1 | (uint64_t) view.paused << 2 | (uint64_t) useSoftwarePost << 3);
+            key = TrackGenerator::Mix(key ^ (uint32_t) ColorToInt(Quantised(backgroundColor)) ^ (uint64_t) (bloomIntensity * 32.0f) << 32);
+            key = TrackGenerator::Mix(key ^ ((uint64_t) (int64_t) view.score << 32 | (uint32_t) view.hue));
+            key = TrackGenerator::Mix(key ^ (uint64_t) view.runs << 1 ^ (uint64_t) (view.rewindable > 0.0f));
+            return key | 1;
+        }
+
+        // Screen input is read every frame, including frames that reuse the cached image. Any key ends a demo run.
+        void ScreenInput(const WorldSnapshot& view) {
+            if (introState) return;
+
+            const double now = Now();
+            if (idleSince == 0.0) idleSince = now;
+
+            if (view.demo) {
+                if (GetKeyPressed() != 0) menuRequested = true;
+                idleSince = now;
+            } else if (!view.started || view.dead) {
+                int key = GetKeyPressed();
+                if (key == KEY_SPACE) startRequested = true;
+                if (key == KEY_R && view.started) rewindRequested++;
+
+                if (key != 0 || view.started) idleSince = now;
+                else if (attractDelay > 0.0 && now - idleSince > attractDelay) demoRequested = true, idleSince = now;
+            } else {
+                if (IsKeyPressed(KEY_P)) pauseRequested = true;
+                if (IsKeyPressed(KEY_R)) rewindRequested++;
+                idleSince = now;
+            }
+        }
+
+        void DrawScreen(const WorldSnapshot& view) {
+            if (introState) {
+                DrawTextCentered("AERMOSS", 0, 200, BLACK);
+            } else {
+                if (!view.started) { Menu(); }
+                else if (!view.dead) { Game(view); }
+                else { GameOver(view); }
+            }
+        }
+
+        // Replaces EndDrawing() so input polling can be left to the frame pacer.
+        void Present() {
+            rlDrawRenderBatchActive();
+            capture->Frame();
+            SwapScreenBuffer();
+            pacer.Presented();
+
+            profiler.Record("latch to present", pacer.LatchToPresent());
+            profiler.Record("input to photon (est)", pacer.InputToPhoton());
+            profiler.Record("pacer sleep", pacer.SleepTime());
+            profiler.Record("pacer spin", pacer.SpinTime());
+
+            if (telemetry)
+                telemetry->Frame({ (uint32_t) (frameTime * 1e6f), (uint32_t) (pacer.LatchToPresent() * 1e3), (uint32_t) (pacer.SleepTime() * 1e3), (uint32_t) (postTime * 1e6) });
+        }
+
+        void Frame() {
+            pacer.Latch();
+            frameTime = pacer.FrameTime();
+            postTime = 0.0;
+
+            snapshots.Update();
+            const WorldSnapshot& view = snapshots.Front();
+
+            if (spectators) {
+                Profiler::Scope scope(profiler, "spectator broadcast");
+                spectators->Frame(view, Now());
+            }
+
+            heldKeys.store((IsKeyDown(KEY_A) ? holdLeft : 0) | (IsKeyDown(KEY_D) ? holdRight : 0) | (IsKeyDown(KEY_F) ? holdSlow : 0), std::memory_order_relaxed);
+
+            if (view.Torn() || view.sequence < lastSequence) tornSnapshots++;
+            lastSequence = view.sequence;
+            profiler.Count("torn snapshots", (double) tornSnapshots);
+            profiler.Count("track chunks ahead", (double) track->Lookahead());
+
+            if (view.runs != playedRuns) {
+                playedRuns = view.runs, soundPaused = false;
+                sinceBeat = 0.0f, passBeat = 8 * 4 - 1;
+                PlaySound(music);
+                if (spectrum) spectrum->Play();
+            }
+
+            if (view.paused != soundPaused) {
+                soundPaused = view.paused;
+                if (soundPaused) PauseSound(music);
+                else ResumeSound(music);
+                if (spectrum) soundPaused ? spectrum->Pause() : spectrum->Resume();
+            }
+
+            // The levels hold while the music is paused, and bloom moves in steps of 1/32, so static screens can be keyed.
+            if (spectrum && !soundPaused) audio = spectrum->Bands();
+            bloomIntensity = spectrum ? std::round((1.0f + 0.6f * audio.bass + 0.4f * audio.pulse) * 32.0f) / 32.0f : 1.0f;
+
+            const bool started = view.started, dead = view.dead, paused = view.paused;
+            const int hue = view.hue;
+
+            if (IsSoundPlaying(music))
+                sinceBeat += frameTime;
+
+            if (sinceBeat >= 60.0f / bpm) {
+                sinceBeat = sinceBeat - 60.0f / bpm;
+
+                if (passBeat != 0) { passBeat--; }
+                else if (!spectrum) {
+                    backgroundColor = (started && dead) ? RED : ((!started && !dead) ? VIOLET : ColorFromHSV(hue, 1, 1));
                 }
+            }
 
-                if (introState) {
-                    introState = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() < 1000.0f;
-                    if (!introState) backgroundColor = BLACK;
-                } else {
-                    if (!(started && !dead && paused)) {
-                        backgroundColor.r = lerp(backgroundColor.r, 0.0f, GetFrameTime() * 3.0f);
-                        backgroundColor.g = lerp(backgroundColor.g, 0.0f, GetFrameTime() * 3.0f);
-                        backgroundColor.b = lerp(backgroundColor.b, 0.0f, GetFrameTime() * 3.0f);
-                    }
+            // The timer still sits out the intro; after that, flashes land on onsets in the music, as bright as the bass.
+            if (spectrum && audio.onsets != seenOnsets) {
+                seenOnsets = audio.onsets;
+
+                if (passBeat == 0) {
+                    const float value = 0.5f + 0.5f * audio.bass;
+                    const Color flash = (started && dead) ? RED : ((!started && !dead) ? VIOLET : ColorFromHSV(hue, 1, 1));
+                    backgroundColor = { (unsigned char) (flash.r * value), (unsigned char) (flash.g * value), (unsigned char) (flash.b * value), 255 };
                 }
+            }
 
-                BeginTextureMode(firstTarget);
-                ClearBackground(backgroundColor);
+            if (deathState != dead || startState != started) {
+                startState = started, deathState = dead;
+                backgroundColor = BLACK;
+            }
 
-                if (introState) {
-                    DrawTextCentered("AERMOSS", 0, 200, BLACK);
-                } else {
-                    if (!started) { Menu(); }
-                    else if (!dead) { Game(); }
-                    else { GameOver(); }
+            if (introState) {
+                introState = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() < 1000.0f;
+                if (!introState) backgroundColor = BLACK;
+            } else {
+                if (!(started && !dead && paused)) {
+                    backgroundColor.r = lerp(backgroundColor.r, 0.0f, frameTime * 3.0f);
+                    backgroundColor.g = lerp(backgroundColor.g, 0.0f, frameTime * 3.0f);
+                    backgroundColor.b = lerp(backgroundColor.b, 0.0f, frameTime * 3.0f);
                 }
+            }
 
-                EndTextureMode();
+            ScreenInput(view);
 
-                BeginTextureMode(secondTarget);
-                BeginShaderMode(bloomShader);
-                DrawTextureRec(firstTarget.texture, { 0, 0, (float) firstTarget.texture.width, (float) -firstTarget.texture.height }, { 0, 0 }, WHITE);
-                EndShaderMode();
-                EndTextureMode();
+            if (IsKeyPressed(KEY_F2))
+                useSoftwarePost = !useSoftwarePost;
+
+            if (powerSaver) pacer.SetRate(std::min(displayRate, started && !dead ? (paused ? pausedFrameRate : displayRate) : idleFrameRate));
 
+            uint64_t key = StaticKey(view);
+            profiler.Count("static frames", (double) staticFrames);
+            profiler.Count("cached text frames", (double) textFrames);
+            profiler.Count("post targets", (double) postGraph.Targets());
+
+            if (key != 0 && key == cachedKey) {
+                staticFrames++;
                 BeginDrawing();
-                BeginShaderMode(crtShader);
-                DrawTextureRec(secondTarget.texture, { 0, 0, (float) secondTarget.texture.width, (float) -secondTarget.texture.height }, { 0, 0 }, WHITE);
-                EndShaderMode();
-                EndDrawing();
+                PresentCached();
+                Present();
 
-                if (IsKeyPressed(KEY_F1))
-                    TakeScreenshot("screenshot.png");
+                DebugKeys();
+                return;
             }
 
-            for (Entity* entity : obstacles)
-                delete entity;
+            // The text is drawn onto a transparent layer with the default font, whose alpha is all or nothing, so
+            // laying it over the background gives the same pixels as drawing it there.
+            const uint64_t text = TextKey(view);
+            if (text != 0 && text != textKey) {
+                BeginTextureMode(textLayer);
+                ClearBackground(BLANK);
+                DrawScreen(view);
+                EndTextureMode();
+            } else if (text != 0) {
+                textFrames++;
+            }
 
-            UnloadShader(bloomShader);
-            UnloadShader(crtShader);
+            textKey = text;
 
-            UnloadRenderTexture(firstTarget);
-            UnloadRenderTexture(secondTarget);
+            BeginTextureMode(firstTarget);
+            ClearBackground(key != 0 ? Quantised(backgroundColor) : backgroundColor);
+            if (text != 0) DrawTarget(textLayer.texture);
+            else DrawScreen(view);
+            if (IsKeyDown(KEY_Q)) profiler.Draw(10, 45, 20, LIGHTGRAY), memory.Draw(width - 300, 45, 20, LIGHTGRAY);
+            EndTextureMode();
 
-            UnloadSound(music);
-            CloseAudioDevice();
+            const double postBegin = Now();
 
-            obstacles.clear();
-            CloseWindow();
-        }
+            if (useSoftwarePost) {
+                {
+                    Profiler::Scope scope(profiler, "post (software)");
+                    SoftwarePostProcessFrame();
+                }
 
-        void Menu() {
-            if (IsKeyDown(KEY_Q)) DrawText((std::to_string(GetFPS()) + " FPS").c_str(), 10, 10, 25, VIOLET);
-            DrawTextCentered("CRAWL", 0, 100, VIOLET);
-            DrawTextCentered("press space to start", 100 / 2 + 20 / 2, 20, LIGHTGRAY);
+                postTime = Now() - postBegin;
+
+                BeginDrawing();
+                PresentCached();
+                Present();
+            } else if (key != 0) {
+                {
+                    Profiler::Scope scope(profiler, "post (shader)");
+                    ShaderPostProcess(&cachedFrame);
+                }
+
+                postTime = Now() - postBegin;
 
-            if (GetKeyPressed() == KEY_SPACE) {
-                Reset(), started = true;
-                
-                for (int i = 0; i < maxObstacles; i++) {
-                    int n; while((n = rand()) > RAND_MAX - (RAND_MAX - 5) % 8); ChangeHue();
-                    obstacles.push_back(new Entity({(float) ((n % 8) + 1) - 4, 0.0f, (i + 1) * -10.0f}, {2.0f, 2.0f, 2.0f}, ColorFromHSV(hue, 1, 1)));
+                BeginDrawing();
+                PresentCached();
+                Present();
+            } else {
+                {
+                    Profiler::Scope scope(profiler, "post (shader)");
+                    ShaderPostProcess(nullptr);
                 }
+
+                postTime = Now() - postBegin;
+
+                Present();
             }
+
+            cachedKey = key;
+
+            DebugKeys();
         }
 
-        void Game() {
-            BeginMode3D(camera);
-            entity->Draw();
+        void DebugKeys() {
+            if (IsKeyPressed(KEY_F1)) capture->RequestScreenshot();
+            if (IsKeyPressed(KEY_F3)) capture->SetRecording(!capture->Recording());
+            if (IsKeyPressed(KEY_F4)) memory.Dump(stdout);
+
+            profiler.Count("capture written", (double) capture->Written());
+            profiler.Count("capture dropped", (double) capture->Dropped());
+        }
 
-            if (IsKeyPressed(KEY_P)) {
-                paused = !paused;
+        // Copies the state the renderer needs into the free snapshot slot and hands it over.
+        void Publish() {
+            Allocations::Scope scope(Allocations::Snapshots);
+            WorldSnapshot& snapshot = snapshots.Back();
+            snapshot.sequence = ++published;
 
-                if (paused) {
-                    PauseSound(music);
-                } else {
-                    ResumeSound(music);
+            Players& players = world.Get<Players>();
+            snapshot.previousPosition = previousPosition, snapshot.position = Player().position;
+            snapshot.size = players.Get<Bounds>(0).size, snapshot.color = players.Get<Tint>(0).color;
+            snapshot.previousCamera = previousCamera, snapshot.camera = camera;
+            snapshot.obstacles.resize(world.Get<Obstacles>().Size());
+
+            ObstacleState* out = snapshot.obstacles.data();
+            world.Get<Obstacles>().EachChunk<Location, Bounds, Tint>([&](size_t count, Location* locations, Bounds* bounds, Tint* tints) {
+                for (size_t i = 0; i < count; i++) *out++ = { locations[i].position, bounds[i].size, tints[i].color };
+            });
+
+            snapshot.tickClock = tickClock, snapshot.origin = origin, snapshot.alpha = accumulator / tickTime;
+            snapshot.speed = speed, snapshot.score = score;
+            snapshot.hue = hue, snapshot.maxObstacles = maxObstacles, snapshot.runs = runs;
+            snapshot.started = started, snapshot.dead = dead, snapshot.paused = paused, snapshot.demo = demo;
+            snapshot.rewindable = rewind && !rewind->Empty() ? (float) ((rewind->Newest() - rewind->Oldest()) * tickTime) : 0.0f;
+
+            snapshot.check = snapshot.sequence;
+            snapshots.Publish();
+        }
+
+        void SimulationLoop() {
+            auto last = std::chrono::steady_clock::now();
+            auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(tickTime));
+
+            auto idleStep = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(1.0f / 60.0f));
+
+            while (simulating.load(std::memory_order_relaxed)) {
+                bool changed = false;
+
+                if (startRequested.exchange(false) && (!started || dead)) StartRun(), demo = false, changed = true;
+                if (demoRequested.exchange(false) && !started) StartRun(), demo = true, changed = true;
+                if (menuRequested.exchange(false) && demo) started = false, demo = false, changed = true;
+                if (demo && dead) StartRun(), changed = true;
+                if (int presses = rewindRequested.exchange(0)) if (started && !demo && RewindBy(presses * rewindStep)) changed = true;
+
+                if (pauseRequested.exchange(false) && started && !dead) {
+                    paused = !paused, changed = true;
+                    if (paused) timeScale = 0.0f;
+                }
+
+                auto now = std::chrono::steady_clock::now();
+                float elapsed = std::chrono::duration<float>(now - last).count();
+                last = now;
+
+                bool running = started && !dead && !paused;
+                if (running) {
+                    Simulate(elapsed);
+                    tickClock = Now() - accumulator;
                 }
+
+                // Nothing moves outside of a run, so the thread only wakes up to pick up start and pause requests.
+                if (running || changed || !powerSaver) Publish();
+                std::this_thread::sleep_until(now + (running || !powerSaver ? step : idleStep));
             }
+        }
 
-            timeScale = lerp(timeScale, IsKeyDown(KEY_F) ? 25.0f : 75.0f, GetFrameTime() * 2.0f);
-            
-            if (!paused) {
-                if (IsKeyDown(KEY_A)) targetX -= speed * GetFrameTime() * timeScale;
-                if (IsKeyDown(KEY_D)) targetX += speed * GetFrameTime() * timeScale;
-                if (targetX > 4.0f) targetX = 4.0f;
-                if (targetX < -4.0f) targetX = -4.0f;
-
-                speed += 0.0001f * GetFrameTime() * timeScale;
-                score += speed * GetFrameTime() * timeScale;
-                entity->position.x = lerp(entity->position.x, targetX, 0.2f * GetFrameTime() * timeScale);
-                entity->position.z -= speed * GetFrameTime() * timeScale;
-                camera.target.z = entity->position.z;
-                camera.position.y = entity->position.y + 7.0f;
-                camera.position.z = entity->position.z + 10.0f + speed;
-                camera.position.x = lerp(camera.position.x, entity->position.x, 0.1f * GetFrameTime() * timeScale);
-                camera.target.x = lerp(camera.target.x, camera.position.x, 0.2f * GetFrameTime() * timeScale);
-                camera.target.y = lerp(camera.target.y, entity->position.y, 0.2f * GetFrameTime() * timeScale);
-
-                if (camera.fovy < 150.0f)
-                    camera.fovy = 60.0f + speed;
-            } else {
-                timeScale = 0.0f;
+        void StartSimulation() {
+            Publish();
+            track->Start();
+            simulating = true;
+            simulation = std::thread(&App::SimulationLoop, this);
+        }
+
+        void StopSimulation() {
+            simulating = false;
+            simulation.join();
+        }
+
+        // Watches a game started with --broadcast. Packets take the simulation thread's place as the source of
+        // snapshots, and frames are drawn by the same code as the game's.
+        int Spectate(const Endpoint& server) {
+            SpectatorClient client;
+
+            if (!client.Open(server)) {
+                std::printf("could not open a spectator socket\n");
+                return 1;
             }
 
-            for (size_t i = 0; i < obstacles.size(); i++) {
-                if (entity->Collide(obstacles[i])) {
-                    dead = true; break;
-                } if (obstacles[i]->position.z - entity->position.z > 10) {
-                    delete obstacles[i];
-                    obstacles.erase(obstacles.begin() + i);
+            Init();
+
+            while (!WindowShouldClose()) {
+                const double now = Now();
+                client.Poll(now);
 
-                    int n; {
-                        while ((n = rand()) > RAND_MAX - (RAND_MAX - 5) % 6);
-                    } ChangeHue();
+                WorldSnapshot& snapshot = snapshots.Back();
+                snapshot.sequence = ++published;
+                client.Fill(snapshot, now);
+                snapshot.check = snapshot.sequence;
+                snapshots.Publish();
 
-                    obstacles.push_back(new Entity({(float) ((n % 8) + 1) - 4, 0.0f, entity->position.z - (maxObstacles * 10.0f)}, {2.0f, 2.0f, 2.0f}, ColorFromHSV(hue, 1, 1)));
-                } obstacles[i]->Draw();
+                Frame();
             }
 
-            DrawPlane({0.0f, -1.0f, entity->position.z}, {10, 500}, {5, 5, 5, 255});
-            EndMode3D();
+            Shutdown();
+            return 0;
+        }
+
+        void Run() {
+            Init();
+            StartSimulation();
+
+            while (!WindowShouldClose())
+                Frame();
 
-            if (paused) DrawText("paused", 10, height - 10 - 30 - 50, 50, ColorFromHSV(hue - maxObstacles, 1, 1));
-            if (IsKeyDown(KEY_Q)) DrawText((std::to_string(GetFPS()) + " FPS").c_str(), 10, 10, 25, ColorFromHSV(hue - maxObstacles, 1, 1));
-            DrawText((std::string("score: ") + std::to_string((int) score)).c_str(), 10, height - 10 - 30, 30, ColorFromHSV(hue - maxObstacles, 1, 1));
+            StopSimulation();
+            Shutdown();
         }
 
-        void GameOver() {
-            if (IsKeyDown(KEY_Q)) DrawText((std::to_string(GetFPS()) + " FPS").c_str(), 10, 10, 25, RED);
-            DrawText((std::string("score: ") + std::to_string((int) score)).c_str(), 10, height - 10 - 30, 30, LIGHTGRAY);
-            DrawTextCentered("GAME OVER", 0, 100, RED);
-            DrawTextCentered("press space to play again", 100 / 2 + 20 / 2, 20, LIGHTGRAY);
+        // Drives one run without a window through a fixed input script, with collisions counted instead of fatal.
+        void BeginScriptedRun(unsigned runSeed, float rebaseAt) {
+            seed = runSeed, rebaseDistance = rebaseAt, ghost = true;
+            track = std::make_unique<TrackGenerator>(seed);
+            StartRun();
+        }
+
+        void EndScriptedRun() {
+            world.Get<Obstacles>().Clear();
+            track.reset();
+        }
+
+        void ScriptedTick(uint64_t tick) {
+            heldKeys.store((uint8_t) (TrackGenerator::Mix(tick / 30) % 3), std::memory_order_relaxed);
+            Tick();
+        }
+
+        // Runs the same scripted, collision-proof run with and without rebasing out to `distance`. Checks that every
+        // rebase leaves offsets between the player, camera and obstacles bit for bit unchanged and that positions stay
+        // small and in step with the double-precision score, while the unrebased run shows the drift it replaces.
+        static int CheckRebasing(unsigned runSeed, double distance) {
+            auto rebased = std::make_unique<App>(), reference = std::make_unique<App>();
+            rebased->BeginScriptedRun(runSeed, 1024.0f);
+            reference->BeginScriptedRun(runSeed, INFINITY);
 
-            if (GetKeyPressed() == KEY_SPACE) {
-                for (Entity* entity : obstacles)
-                    delete entity;
+            double rebasedDrift = 0.0, referenceDrift = 0.0, checkpoint = 1000.0;
+            float largest = 0.0f;
+            uint64_t moved = 0, rebases = 0;
+            std::vector<float> before;
 
-                obstacles.clear();
-                Reset(), started = true;
+            auto offsets = [](App& app, std::vector<float>& out) {
+                out.clear();
+                const float z = app.Player().position.z;
+                out.push_back(app.camera.position.z - z), out.push_back(app.camera.target.z - z), out.push_back(app.previousPosition.z - z);
+                app.world.Get<Obstacles>().Each<Location>([&](Location& obstacle) { out.push_back(obstacle.position.z - z); });
+            };
 
-                for (int i = 0; i < maxObstacles; i++) {
-                    int n; {
-                        while ((n = rand()) > RAND_MAX - (RAND_MAX - 5) % 6);
-                    } ChangeHue();
+            std::printf("%12s %10s %12s %12s %12s %12s %12s\n", "distance", "local z", "drift", "collisions", "ref z ulp", "ref drift", "ref collisions");
 
-                    obstacles.push_back(new Entity({(float) ((n % 8) + 1) - 4, 0.0f, (i + 1) * -10.0f}, {2.0f, 2.0f, 2.0f}, ColorFromHSV(hue, 1, 1)));
+            for (uint64_t tick = 0; rebased->score < distance; tick++) {
+                // Rebase ahead of the tick, which then finds nothing left to do, so the shift can be checked alone.
+                if (rebased->Player().position.z <= -rebased->rebaseDistance) {
+                    std::vector<float> after;
+                    offsets(*rebased, before);
+                    rebased->Rebase(), rebases++;
+                    offsets(*rebased, after);
+                    if (std::memcmp(before.data(), after.data(), before.size() * sizeof(float)) != 0) moved++;
                 }
+
+                rebased->ScriptedTick(tick), reference->ScriptedTick(tick);
+
+                const float z = rebased->Player().position.z;
+                largest = std::max(largest, std::fabs(z));
+                rebasedDrift = std::max(rebasedDrift, std::fabs(rebased->origin - z - rebased->score));
+                referenceDrift = std::max(referenceDrift, std::fabs(reference->origin - reference->Player().position.z - reference->score));
+
+                if (rebased->score < checkpoint) continue;
+                float referenceZ = std::fabs(reference->Player().position.z);
+                std::printf("%12.0f %10.2f %12.3g %12llu %12.3g %12.3g %12llu\n", rebased->score, z, rebasedDrift, (unsigned long long) rebased->collisions,
+                    std::nextafter(referenceZ, INFINITY) - referenceZ, referenceDrift, (unsigned long long) reference->collisions);
+                checkpoint *= 10.0;
             }
+
+            // Per tick rounding of the float position still adds up, but only relative to the distance covered.
+            bool exact = moved == 0, bounded = largest <= 1024.0f + 64.0f, tracked = rebasedDrift < 1e-6 * distance + 0.01;
+            std::printf("%llu rebases, %llu moved offsets, largest local |z| %.1f, drift %.3g -> %s\n", (unsigned long long) rebases, (unsigned long long) moved, largest, rebasedDrift,
+                exact && bounded && tracked ? "passed" : "FAILED");
+
+            rebased->EndScriptedRun(), reference->EndScriptedRun();
+            return exact && bounded && tracked ? 0 : 1;
         }
-};
 
-int main(int argc, const char* argv[]) {
-    App app;
+        // Plays a scripted run next to an identical reference run and rewinds the first one by increasing amounts, up
+        // to past the end of the window. The restored state must match the reference at that tick bit for bit, and
+        // replaying the same input from there must land exactly on the reference again, track generator included.
+        static int CheckRewind(unsigned runSeed, double window) {
+            auto rewinding = std::make_unique<App>(), reference = std::make_unique<App>();
+            rewinding->practiceSeconds = window, rewinding->EnableRewind();
+            rewinding->BeginScriptedRun(runSeed, 1024.0f), reference->BeginScriptedRun(runSeed, 1024.0f);
+            rewinding->track->Start();
+
+            auto state = [](App& app, std::vector<uint8_t>& out) {
+                out.clear();
+                auto put = [&](const auto& value) { const uint8_t* bytes = (const uint8_t*) &value; out.insert(out.end(), bytes, bytes + sizeof(value)); };
+                put(app.Player().position), put(app.camera.position), put(app.camera.target), put(app.camera.fovy);
+                put(app.score), put(app.origin), put(app.speed), put(app.timeScale), put(app.targetX), put(app.hue), put(app.hueState);
+                app.world.Get<Obstacles>().Each<Location, Tint>([&](Location& location, Tint& tint) { put(location.position), put(tint.color); });
+            };
+
+            const uint64_t rate = (uint64_t) std::llround(1.0 / rewinding->tickTime), span = (uint64_t) (2.0 * window * rate);
+            std::vector<std::vector<uint8_t>> history(span + 1);
+            std::vector<uint8_t> current;
+            uint64_t tick = 0;
+            int failures = 0;
+
+            state(*reference, history[0]);
+            std::printf("%10s %10s %12s %12s %10s %10s %12s\n", "back (s)", "tick", "restored", "restore us", "state", "replay", "buffer (KB)");
+
+            for (double back : { 1.0 / rate, 1.0, 5.0, window * 0.5, window, window * 2.0 }) {
+                for (uint64_t end = tick + span; tick < end; tick++) {
+                    rewinding->ScriptedTick(tick), reference->ScriptedTick(tick);
+                    state(*reference, history[(tick + 1) % history.size()]);
+                }
+
+                auto begin = std::chrono::high_resolution_clock::now();
+                bool restored = rewinding->RewindBy(back);
+                double micros = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - begin).count();
+
+                const uint64_t target = rewinding->rewind->Newest();
+                state(*rewinding, current);
+                bool same = restored && target + span >= tick && current == history[target % history.size()];
+
+                for (uint64_t replay = target; replay < tick; replay++) rewinding->ScriptedTick(replay);
+                state(*rewinding, current);
+                bool replayed = current == history[tick % history.size()];
+
+                failures += !same + !replayed;
+                std::printf("%10.3f %10llu %12llu %12.1f %10s %10s %12.1f\n", back, (unsigned long long) tick, (unsigned long long) target, micros,
+                    same ? "exact" : "DIFFERS", replayed ? "exact" : "DIFFERS", rewinding->rewind->Bytes() / 1024.0);
+            }
+
+            std::printf("%.0f s window at %llu Hz -> %s\n", window, (unsigned long long) rate, failures == 0 ? "passed" : "FAILED");
+            rewinding->EndScriptedRun(), reference->EndScriptedRun();
+            return failures == 0 ? 0 : 1;
+        }
+
+        // Streams a scripted run over loopback, at 60 frames a second of game time, to one spectator on a clean link and
+        // one that loses a tenth of its packets. Every packet either of them applies must rebuild the state that was
+        // sent bit for bit, and the lossy one must lose nothing beyond the packets that were dropped. A third socket
+        // acks without the cookie the whole time and must never be sent more than it sends. Fails if either spectator
+        // is ever out of step or the stream needs more than `budget` bytes a second per spectator on the wire.
+        static int CheckSpectator(unsigned runSeed, double seconds, double budget = 4096.0) {
+            auto game = std::make_unique<App>();
+            game->BeginScriptedRun(runSeed, 1024.0f);
+
+            SpectatorServer server;
+            SpectatorClient clean, lossy;
+            UdpSocket intruder;
+
+            if (!server.Open(0) || !clean.Open({ Endpoint::loopback, server.Port() }) || !lossy.Open({ Endpoint::loopback, server.Port() }) || !intruder.Open({ Endpoint::loopback, 0 })) {
+                std::printf("could not open loopback sockets\n");
+                return 1;
+            }
+
+            lossy.SetLoss(10);
+            SpectatorFrame expected;
+            uint64_t sent = 0, checked = 0, mismatched = 0, lossyChecked = 0, lossyMismatched = 0, late = 0;
+            uint64_t intruderSent = 0, intruderReceived = 0, intruderStates = 0;
+            size_t largest = 0;
+            double report = 10.0;
+
+            const uint64_t ticks = (uint64_t) (seconds / game->tickTime);
+            std::printf("%10s %10s %10s %12s %12s %12s\n", "seconds", "score", "packets", "bytes/s", "mismatched", "lossy skips");
+
+            for (uint64_t tick = 0; tick < ticks; tick++) {
+                game->ScriptedTick(tick);
+                if (tick % 4 != 3) continue;
+
+                const double now = (tick + 1) * game->tickTime;
+                clean.Poll(now), lossy.Poll(now);
+
+                const uint32_t forged[3] = { SpectatorCodec::ackMagic, 0, (uint32_t) tick | 1 };
+                if (intruder.Send({ Endpoint::loopback, server.Port() }, forged, sizeof(forged))) intruderSent += sizeof(forged);
+
+                uint32_t reply[16];
+                Endpoint from;
+                for (int size; (size = intruder.Receive(reply, sizeof(reply), from)) >= 0;)
+                    intruderReceived += size, intruderStates += size < 4 || reply[0] != SpectatorCodec::challengeMagic;
+
+                game->Publish(), game->snapshots.Update();
+                const WorldSnapshot& view = game->snapshots.Front();
+                const uint64_t bytes = server.Bytes();
+                server.Frame(view, now);
+                if (server.Bytes() == bytes) continue;
+
+                sent++, largest = std::max(largest, (size_t) ((server.Bytes() - bytes) / server.Spectators()));
+                expected.From(view);
+
+                // Loopback delivery is all but immediate; give it a moment rather than count on it.
+                for (int spin = 0; spin < 2000 && clean.Applied() != server.Sequence(); spin++) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    clean.Poll(now), lossy.Poll(now);
+                }
+
+                if (clean.Applied() != server.Sequence()) { late++; continue; }
+                checked++, mismatched += !(clean.State() == expected);
+                if (lossy.Applied() == server.Sequence()) lossyChecked++, lossyMismatched += !(lossy.State() == expected);
+
+                if (now >= report)
+                    report += 10.0, std::printf("%10.0f %10.0f %10llu %12.0f %12llu %12llu\n", now, game->score, (unsigned long long) sent,
+                        (server.Bytes() / server.Spectators() + sent * 28.0) / now, (unsigned long long) mismatched, (unsigned long long) lossy.Skipped());
+            }
+
+            // IPv4 and UDP headers add 28 bytes to every datagram.
+            const double payload = (double) server.Bytes() / 2 / seconds, wire = payload + sent * 28.0 / seconds;
+            const bool passed = checked > 0 && late == 0 && mismatched == 0 && lossyMismatched == 0 && lossy.Skipped() == 0 && lossyChecked > checked * 8 / 10 && wire <= budget &&
+                intruderStates == 0 && intruderReceived <= intruderSent;
+
+            std::printf("%llu packets (%llu keyframes), largest %zu bytes, %.0f bytes/s payload, %.0f bytes/s on the wire per spectator\n",
+                (unsigned long long) sent, (unsigned long long) server.Keyframes(), largest, payload, wire);
+            std::printf("clean: %llu checked, %llu mismatched, %llu late; lossy: %llu applied, %llu skipped, %llu mismatched -> %s\n",
+                (unsigned long long) checked, (unsigned long long) mismatched, (unsigned long long) late, (unsigned long long) lossyChecked,
+                (unsigned long long) lossy.Skipped(), (unsigned long long) lossyMismatched, passed ? "passed" : "FAILED");
+            std::printf("unverified acks: %llu bytes sent, %llu bytes of challenges back, %llu state packets\n",
+                (unsigned long long) intruderSent, (unsigned long long) intruderReceived, (unsigned long long) intruderStates);
+
+            game->EndScriptedRun();
+            return passed ? 0 : 1;
+        }
+
+        // Plays automated runs back to back through the normal menu, game and game over paths and prints, once per
+        // interval, resident memory, live heap, allocation rate, frame work time percentiles and how far the float
+        // z coordinate has drifted from the distance travelled. Fails on growth, slowdown or visible drift.
+        int Soak(double seconds) {
+            Init();
+            autopilot = true;
+            StartSimulation();
+
+            const double begin = Now(), interval = std::max(5.0, std::min(60.0, seconds / 20.0)), bucket = 0.05;
+            std::vector<uint32_t> histogram(2000, 0);
+            double nextReport = begin + interval, worstDrift = 0.0, intervalDrift = 0.0, firstP99 = -1.0, lastP99 = 0.0, furthest = 0.0;
+            int64_t firstRss = -1, lastRss = 0, firstHeap = -1, lastHeap = 0;
+            uint64_t allocations = Allocations::Count(), frames = 0;
+            float largest = 0.0f;
+
+            auto percentile = [&](double fraction) {
+                uint64_t target = (uint64_t) std::ceil(frames * fraction), seen = 0;
+                for (size_t i = 0; i < histogram.size(); i++)
+                    if ((seen += histogram[i]) >= target) return (i + 1) * bucket;
+                return histogram.size() * bucket;
+            };
+
+            std::printf("%8s %6s %10s %10s %10s %8s %8s %8s %10s %10s %10s\n", "time", "runs", "rss (KB)", "heap (KB)", "allocs/s", "p50 ms", "p99 ms", "max ms", "furthest", "ulp", "drift");
+
+            while (Now() - begin < seconds && !WindowShouldClose()) {
+                Frame();
+
+                const WorldSnapshot& view = snapshots.Front();
+                if (!introState && (!view.started || view.dead)) startRequested = true;
+
+                histogram[std::min(histogram.size() - 1, (size_t) (pacer.LatchToPresent() / bucket))]++, frames++;
+                intervalDrift = std::max(intervalDrift, std::fabs(view.origin - view.position.z - view.score));
+                furthest = std::max(furthest, view.origin - view.position.z), largest = std::max(largest, std::fabs(view.position.z));
+
+                double now = Now();
+                if (now < nextReport) continue;
+
+                double p99 = percentile(0.99);
+                int64_t rss = ResidentBytes(), heap = Allocations::Current();
+                uint64_t count = Allocations::Count();
+                float ulp = std::nextafter(largest, INFINITY) - largest;
+
+                std::printf("%8.0f %6d %10lld %10lld %10.0f %8.2f %8.2f %8.2f %10.0f %10.2g %10.2g\n", now - begin, view.runs, (long long) rss / 1024, (long long) heap / 1024,
+                    (count - allocations) / (now - nextReport + interval), percentile(0.5), p99, percentile(1.0), furthest, ulp, intervalDrift);
+                std::fflush(stdout);
+
+                // The first interval is the warm-up everything else is compared against.
+                if (firstRss < 0) firstRss = rss, firstHeap = heap, firstP99 = p99;
+                lastRss = rss, lastHeap = heap, lastP99 = p99;
+                worstDrift = std::max(worstDrift, intervalDrift);
+
+                std::fill(histogram.begin(), histogram.end(), 0);
+                allocations = count, frames = 0, intervalDrift = 0.0, furthest = 0.0, largest = 0.0f;
+                nextReport = now + interval;
+            }
+
+            StopSimulation();
+            Shutdown();
+
+            bool leaked = lastRss > firstRss + 32 * 1048576 || lastHeap > firstHeap + 64 * 1024;
+            bool slowed = lastP99 > firstP99 * 1.5 + 0.5;
+            bool drifted = worstDrift > 0.5;
+
+            std::printf("rss %+lld KB, heap %+lld KB, p99 %.2f -> %.2f ms, worst drift %.3g units\n", (long long) (lastRss - firstRss) / 1024, (long long) (lastHeap - firstHeap) / 1024, firstP99, lastP99, worstDrift);
+            std::printf("%s%s%s\n", leaked ? "LEAK " : "", slowed ? "SLOWDOWN " : "", drifted ? "DRIFT" : (leaked || slowed ? "" : "steady"));
+            return leaked || slowed || drifted ? 1 : 0;
+        }
+
+        // Plays a fixed script with no intro and no frame cap: the menu, runs driven by the autopilot at stepped
+        // speeds, then game over. The simulation advances a fixed four ticks per frame on this thread, so every
+        // machine renders the same frames and only the time they take differs. Frame times cover the ticks and the
+        // whole frame up to the swap. Writes frame time percentiles
+        // overall and per phase, CPU and GPU time per post-processing pass and peak memory to `report` as JSON.
+        int Benchmark(const std::string& report) {
+            struct Phase {
+                const char* name;
+                int frames;
+                float speed;
+            };
+
+            const Phase phases[] = {
+                { "menu", 120, -1.0f },
+                { "speed 0.15", 300, 0.15f }, { "speed 0.5", 300, 0.5f }, { "speed 1", 300, 1.0f }, { "speed 2", 300, 2.0f }, { "speed 4", 300, 4.0f },
+                { "game over", 120, 0.0f },
+            };
+            const int ticksPerFrame = 4;
+            const char* const passes[] = { "bloom", "crt" };
+
+            if (windowWidth == 0 || windowHeight == 0) windowWidth = 1280, windowHeight = 720;
+            powerSaver = false, attractDelay = 0.0, autopilot = true, ghost = true;
+            Init();
+            introState = false, backgroundColor = BLACK;
+            pacer.SetRate(0);
+            track->Start();
+
+            std::vector<double> frames, phaseTimes;
+            double passCpu[2] = {}, passGpu[2] = {};
+            int64_t peakRss = ResidentBytes();
+            frames.reserve(2000);
+
+            auto percentile = [](std::vector<double> times, double fraction) {
+                if (times.empty()) return 0.0;
+                std::sort(times.begin(), times.end());
+                return times[std::min(times.size() - 1, (size_t) (fraction * times.size()))];
+            };
+
+            FILE* json = std::fopen(report.c_str(), "w");
+            if (!json) { std::printf("cannot write %s\n", report.c_str()); Shutdown(); return 1; }
+            std::fprintf(json, "{\n  \"seed\": %u,\n  \"width\": %u,\n  \"height\": %u,\n  \"post\": \"%s%s%s\",\n  \"ticks_per_frame\": %d,\n  \"phases\": [\n",
+                seed, width, height, useSoftwarePost ? "software" : (useBloom ? "bloom" : ""), !useSoftwarePost && useBloom && useCrt ? "," : "",
+                !useSoftwarePost && useCrt ? "crt" : "", ticksPerFrame);
+
+            const double begin = Now();
+
+            for (const Phase& phase : phases) {
+                if (phase.speed < 0.0f) started = false, dead = false;
+                else if (phase.speed == 0.0f) dead = true;
+                else {
+                    if (!started) StartRun();
+                    speed = phase.speed;
+                }
+
+                phaseTimes.clear();
+
+                for (int frame = 0; frame < phase.frames; frame++) {
+                    const double frameBegin = Now();
+                    if (started && !dead)
+                        for (int tick = 0; tick < ticksPerFrame; tick++) Tick();
+
+                    Publish();
+                    Frame();
+
+                    const double milliseconds = (Now() - frameBegin) * 1000.0;
+                    frames.push_back(milliseconds), phaseTimes.push_back(milliseconds);
+
+                    for (int pass = 0; pass < 2; pass++)
+                        passCpu[pass] += postGraph.PassTime(passes[pass]), passGpu[pass] += postGraph.GpuTime(passes[pass]);
+
+                    if (frame % 60 == 0) peakRss = std::max(peakRss, ResidentBytes());
+                }
+
+                std::fprintf(json, "    { \"name\": \"%s\", \"frames\": %d, \"p50_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f }%s\n", phase.name, phase.frames,
+                    percentile(phaseTimes, 0.5), percentile(phaseTimes, 0.99), percentile(phaseTimes, 1.0), &phase == &phases[std::size(phases) - 1] ? "" : ",");
+            }
+
+            const double seconds = Now() - begin;
+            peakRss = std::max(peakRss, ResidentBytes());
+            double mean = 0.0;
+            for (double milliseconds : frames) mean += milliseconds / frames.size();
+
+            std::fprintf(json, "  ],\n  \"frames\": %zu,\n  \"seconds\": %.4f,\n", frames.size(), seconds);
+            std::fprintf(json, "  \"frame_ms\": { \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"p999\": %.4f, \"max\": %.4f },\n",
+                mean, percentile(frames, 0.5), percentile(frames, 0.9), percentile(frames, 0.99), percentile(frames, 0.999), percentile(frames, 1.0));
+
+            // Pass times are per frame over every frame, so static frames that skip post-processing count as zero.
+            std::fprintf(json, "  \"passes\": [\n");
+            for (int pass = 0; pass < 2; pass++)
+                std::fprintf(json, "    { \"name\": \"%s\", \"cpu_ms\": %.4f, \"gpu_ms\": %.4f }%s\n", passes[pass], passCpu[pass] / frames.size(),
+                    passGpu[pass] / frames.size(), pass == 0 ? "," : "");
+
+            std::fprintf(json, "  ],\n  \"memory\": { \"peak_rss_bytes\": %lld, \"peak_heap_bytes\": %lld, \"peak_gpu_bytes\": %lld, \"peak_audio_bytes\": %lld },\n",
+                (long long) peakRss, (long long) Allocations::Peak(), (long long) memory.Peak(MemoryBudget::Gpu), (long long) memory.Peak(MemoryBudget::Audio));
+            std::fprintf(json, "  \"collisions\": %llu,\n  \"score\": %.2f\n}\n", (unsigned long long) collisions, mean > 0.0 ? 1000.0 / mean : 0.0);
+            std::fclose(json);
+
+            std::printf("%zu frames in %.2f s: mean %.3f ms, p99 %.3f ms, score %.2f -> %s\n", frames.size(), seconds, mean, percentile(frames, 0.99),
+                mean > 0.0 ? 1000.0 / mean : 0.0, report.c_str());
+            Shutdown();
+            return 0;
+        }
+
+        // Plays runs back to back without input and fails when live heap usage peaks higher in the second half
+        // of the measured time than in the first, so steady state has to stay flat once warmed up.
+        int CheckMemoryGrowth(double seconds) {
+            const int64_t tolerance = 64 * 1024;
+            Init();
+            StartSimulation();
+
+            const double begin = Now(), warmup = std::min(5.0, seconds * 0.2), middle = warmup + (seconds - warmup) * 0.5;
+            int64_t early = 0, late = 0;
+
+            while (Now() - begin < seconds && !WindowShouldClose()) {
+                Frame();
+
+                const WorldSnapshot& view = snapshots.Front();
+                if (!introState && (!view.started || view.dead)) startRequested = true;
+
+                double elapsed = Now() - begin;
+                if (elapsed < warmup) continue;
+
+                int64_t current = Allocations::Current();
+                if (elapsed < middle) early = std::max(early, current);
+                else late = std::max(late, current);
+            }
+
+            StopSimulation();
+            memory.Dump(stdout);
+
+            bool grew = late > early + tolerance;
+            std::printf("heap peak after warm-up: %lld bytes, second half: %lld bytes -> %s\n", (long long) early, (long long) late, grew ? "GREW" : "steady");
+            Shutdown();
+            return grew ? 1 : 0;
+        }
+
+        // Puts the game into one of the intro, menu, gameplay and gameover scenes, the last two after `warmup`
+        // ticks of a fresh run, and returns the snapshot to draw it from.
+        const WorldSnapshot& StageScene(const std::string& name, int warmup = 120) {
+            if (name == "intro") {
+                introState = true, backgroundColor = VIOLET;
+            } else if (name == "menu") {
+                introState = false, started = false, dead = false, backgroundColor = VIOLET;
+            } else {
+                introState = false;
+                StartRun();
+
+                for (int i = 0; i < warmup && !dead; i++)
+                    Simulate(1.0f / 60.0f);
+
+                dead = name == "gameover";
+                backgroundColor = dead ? RED : ColorFromHSV(hue, 1, 1);
+            }
+
+            Publish();
+            snapshots.Update();
+            return snapshots.Front();
+        }
+
+        // Renders fixed frames of every screen offscreen, compares them against the PNGs in `directory` and writes
+        // per-pass timings to `report`. A missing golden counts as a failure; only with `update` set does the
+        // current output become the golden set. Until a golden set has been recorded there is nothing to compare
+        // against, so without `directory` the suite reports itself skipped, with exit code 77, instead of failing.
+        int RunGoldenSuite(const std::string& directory, bool update, const std::string& report) {
+            if (!update && !std::filesystem::is_directory(directory)) {
+                std::printf("no golden set in %s; record one with --update-goldens on a machine that can render the game\n", directory.c_str());
+                return 77;
+            }
+
+            headless = true;
+            if (windowWidth == 0 || windowHeight == 0) windowWidth = 1280, windowHeight = 720;
+            Init();
+
+            std::filesystem::create_directories(directory);
+            RenderTexture2D outputTarget = LoadRenderTexture(width, height);
+            const char* scenes[] = { "intro", "menu", "gameplay", "gameover" };
+            const int repeats = 30;
+            const float threshold = 12.0f, tolerance = 0.005f;
+            int failures = 0;
+
+            FILE* json = std::fopen(report.c_str(), "w");
+            if (json) std::fprintf(json, "{\n  \"seed\": %u,\n  \"width\": %u,\n  \"height\": %u,\n  \"scenes\": [\n", seed, width, height);
+
+            for (size_t index = 0; index < sizeof(scenes) / sizeof(scenes[0]); index++) {
+                const std::string name = scenes[index];
+                const WorldSnapshot& view = StageScene(name);
+                double sceneTime = 0.0, bloomTime = 0.0, crtTime = 0.0, readbackTime = 0.0;
+
+                auto measure = [](double& total, auto&& body) {
+                    auto begin = std::chrono::high_resolution_clock::now();
+                    body();
+                    total += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+                };
+
+                for (int i = 0; i < repeats; i++) {
+                    measure(sceneTime, [&] {
+                        BeginTextureMode(firstTarget);
+                        ClearBackground(backgroundColor);
+                        DrawScreen(view);
+                        EndTextureMode();
+                    });
+
+                    ShaderPostProcess(&outputTarget);
+                    bloomTime += postGraph.PassTime("bloom"), crtTime += postGraph.PassTime("crt");
+                }
+
+                Image actual = {};
+                measure(readbackTime, [&] { actual = LoadImageFromTexture(outputTarget.texture); });
+                ImageFlipVertical(&actual);
+
+                const std::string path = directory + "/" + name + ".png";
+                const char* status = "updated";
+                ImageDifference difference;
+
+                if (update) {
+                    ExportImage(actual, path.c_str());
+                } else if (!FileExists(path.c_str())) {
+                    status = "missing";
+                    failures++;
+                    ExportImage(actual, (directory + "/" + name + ".actual.png").c_str());
+                } else {
+                    Image expected = LoadImage(path.c_str());
+                    ImageFormat(&expected, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+                    difference = CompareImages(expected, actual, threshold);
+                    UnloadImage(expected);
+
+                    bool passed = difference.comparable && difference.outlierRate <= tolerance;
+                    status = passed ? "passed" : "failed";
+
+                    if (!passed) {
+                        failures++;
+                        ExportImage(actual, (directory + "/" + name + ".actual.png").c_str());
+                    }
+                }
+
+                UnloadImage(actual);
+                std::printf("%-9s %-7s mean %.3f, outliers %.3f%%, scene %.3f ms, bloom %.3f ms, crt %.3f ms\n", name.c_str(), status,
+                    difference.mean, difference.outlierRate * 100.0, sceneTime / repeats, bloomTime / repeats, crtTime / repeats);
+
+                if (json) {
+                    std::fprintf(json, "    { \"name\": \"%s\", \"status\": \"%s\", \"mean_difference\": %.4f, \"outlier_rate\": %.6f, ", name.c_str(), status, difference.mean, difference.outlierRate);
+                    std::fprintf(json, "\"scene_ms\": %.4f, \"bloom_ms\": %.4f, \"crt_ms\": %.4f, \"readback_ms\": %.4f }%s\n",
+                        sceneTime / repeats, bloomTime / repeats, crtTime / repeats, readbackTime, index + 1 < sizeof(scenes) / sizeof(scenes[0]) ? "," : "");
+                }
+            }
+
+            if (json) {
+                std::fprintf(json, "  ],\n  \"failures\": %d\n}\n", failures);
+                std::fclose(json);
+            }
+
+            UnloadRenderTexture(outputTarget);
+            Shutdown();
+            return failures == 0 ? 0 : 1;
+        }
+
+        // Times the per-frame simulation pieces without a window, over a range of obstacle counts.
+        void RunMicrobenchmarks(const std::string& filter) {
+            const std::vector<int64_t> counts = { 20, 200, 2000, 20000 };
+            Microbenchmark suite;
+
+            if (!track) track = std::make_unique<TrackGenerator>(seed);
+            hue = 180, hueState = true, speed = 0.15f, timeScale = 75.0f;
+
+            auto prepare = [&](int64_t count) {
+                world.Get<Obstacles>().Clear(), maxObstacles = (int) count, dead = false;
+                Player().position = { 100.0f, 0.0f, 0.0f };
+
+                track->BeginRun();
+
+                for (int i = 0; i < maxObstacles; i++)
+                    world.Get<Obstacles>().Add({ { track->Next().lane, 0.0f, (i + 1) * -10.0f } }, { { 2.0f, 2.0f, 2.0f } }, { ColorFromHSV(hue, 1, 1) });
+            };
+
+            suite.Register("Overlaps", [&](Microbenchmark::State& state) {
+                prepare(state.argument);
+                const Location player = Player();
+                const Bounds size = world.Get<Players>().Get<Bounds>(0);
+
+                for (auto _ : state)
+                    world.Get<Obstacles>().EachChunk<Location, Bounds>([&](size_t count, Location* locations, Bounds* bounds) {
+                        for (size_t i = 0; i < count; i++) Microbenchmark::DoNotOptimize(Overlaps(player, size, locations[i], bounds[i]));
+                    });
+            }, counts);
+
+            suite.Register("UpdateObstacles", [&](Microbenchmark::State& state) {
+                prepare(state.argument);
+
+                for (auto _ : state) {
+                    Player().position.z -= 10.0f;
+                    UpdateObstacles();
+                }
+            }, counts);
+
+            // At the highest speed the steering code still clamps to, with every obstacle fed to the planner.
+            suite.Register("Autopilot::Plan", [&](Microbenchmark::State& state) {
+                prepare(state.argument);
+                Player().position = { 0.0f, 0.0f, 0.0f };
+                speed = 12.0f;
+
+                for (auto _ : state)
+                    Microbenchmark::DoNotOptimize(Steer());
+
+                speed = 0.15f;
+            }, counts);
+
+            // What the render thread pays per frame for telemetry; the argument is the frame time in microseconds.
+            suite.Register("Telemetry::Frame", [&](Microbenchmark::State& state) {
+                Telemetry recorder((std::filesystem::temp_directory_path() / "crawl-telemetry-bench").string(), 1 << 20, 1, 1e9);
+                const uint32_t values[Telemetry::Stages] = { (uint32_t) state.argument, (uint32_t) state.argument / 2, (uint32_t) state.argument / 3, 500 };
+
+                for (auto _ : state)
+                    recorder.Frame(values);
+            }, { 1000, 16667, 100000 });
+
+            // One hop of music analysis, on the analysis thread in the game; the argument selects the SSE path.
+            suite.Register("Spectrum::Analyse", [&](Microbenchmark::State& state) {
+                std::vector<float> noise(Spectrum::size * 4);
+                for (size_t i = 0; i < noise.size(); i++) noise[i] = (float) (TrackGenerator::Mix(i) >> 40) / (1 << 24) * 2.0f - 1.0f;
+
+                Spectrum analysis(noise, 44100);
+                analysis.SetVectorised(state.argument != 0);
+                int64_t end = Spectrum::size;
+
+                for (auto _ : state)
+                    Microbenchmark::DoNotOptimize(analysis.Analyse(end).bass), end = end % (int64_t) noise.size() + Spectrum::hop;
+            }, { 0, 1 });
+
+            suite.Register("ChangeHue", [&](Microbenchmark::State& state) {
+                for (auto _ : state)
+                    for (int64_t i = 0; i < state.argument; i++) ChangeHue();
+                Microbenchmark::DoNotOptimize(hue);
+            }, counts);
+
+            suite.Register("ColorFromHSV", [&](Microbenchmark::State& state) {
+                for (auto _ : state)
+                    for (int64_t i = 0; i < state.argument; i++)
+                        Microbenchmark::DoNotOptimize(ColorFromHSV((float) (hue + i % 360), 1, 1));
+            }, counts);
+
+            suite.Register("TrackGenerator::Next", [&](Microbenchmark::State& state) {
+                track->BeginRun();
+
+                for (auto _ : state)
+                    for (int64_t i = 0; i < state.argument; i++)
+                        Microbenchmark::DoNotOptimize(track->Next());
+            }, counts);
+
+            suite.Register("Advance", [&](Microbenchmark::State& state) {
+                prepare(state.argument);
+
+                for (auto _ : state) {
+                    targetX = -targetX + 1.0f;
+                    Advance(tickTime);
+                }
+
+                Microbenchmark::DoNotOptimize(camera);
+            }, counts);
+
+            suite.Run(filter);
+            world.Get<Obstacles>().Clear();
+        }
+
+        // Renders the menu, a gameplay frame with the obstacles' glow in motion and the game over screen through
+        // both post-process backends, with the bloom pushed to `intensity` as loud music would, then reports their
+        // difference and cost per scene.
+        int ComparePostProcess(int iterations, float intensity = 1.75f) {
+            Init();
+            bloomIntensity = intensity;
+
+            RenderTexture2D shaderTarget = LoadRenderTexture(width, height);
+            const char* scenes[] = { "menu", "gameplay", "gameover" };
+            bool matches = true;
+
+            auto timeBackend = [&](auto&& body) {
+                auto begin = std::chrono::high_resolution_clock::now();
+                for (int i = 0; i < iterations; i++) body(i == iterations - 1);
+                return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count() / iterations;
+            };
+
+            std::printf("post-process backends at %ux%u, bloom intensity %.2f, %d iterations, %zu threads\n", width, height, intensity, iterations, jobPool->Size());
+
+            for (const char* name : scenes) {
+                const WorldSnapshot& view = StageScene(name);
+                BeginTextureMode(firstTarget);
+                ClearBackground(backgroundColor);
+                DrawScreen(view);
+                EndTextureMode();
+
+                Image shaderImage = {};
+                double shaderTime = timeBackend([&](bool last) {
+                    ShaderPostProcess(&shaderTarget);
+                    Image image = LoadImageFromTexture(shaderTarget.texture);
+                    if (last) shaderImage = image;
+                    else UnloadImage(image);
+                });
+
+                double softwareTime = timeBackend([&](bool) {
+                    SoftwarePostProcessFrame();
+                });
+
+                const uint8_t* expected = (const uint8_t*) shaderImage.data;
+                size_t count = (size_t) width * height * 4, outliers = 0;
+                double total = 0.0; int maximum = 0;
+
+                for (size_t i = 0; i < count; i++) {
+                    int difference = std::abs((int) expected[i] - (int) softwareFrame[i]);
+                    total += difference, maximum = std::max(maximum, difference);
+                    if (difference > 16) outliers++;
+                }
+
+                double mean = total / count, outlierRate = (double) outliers / count;
+                bool match = mean <= 2.0 && outlierRate <= 0.01;
+                matches = matches && match;
+
+                std::printf("  %-9s shader %.3f ms, software %.3f ms; difference mean %.3f, max %d, outliers %.3f%% -> %s\n", name,
+                    shaderTime, softwareTime, mean, maximum, outlierRate * 100.0, match ? "match" : "MISMATCH");
+
+                if (!match) {
+                    Image softwareImage = { softwareFrame.data(), (int) width, (int) height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+                    ExportImage(shaderImage, (std::string("post_shader_") + name + ".png").c_str());
+                    ExportImage(softwareImage, (std::string("post_software_") + name + ".png").c_str());
+                }
+
+                UnloadImage(shaderImage);
+            }
+
+            UnloadRenderTexture(shaderTarget);
+            Shutdown();
+            return matches ? 0 : 1;
+        }
+
+        void Menu() {
+            if (IsKeyDown(KEY_Q)) DrawText((std::to_string(pacer.Fps()) + " FPS").c_str(), 10, 10, 25, VIOLET);
+            DrawTextCentered("CRAWL", 0, 100, VIOLET);
+            DrawTextCentered("press space to start", 100 / 2 + 20 / 2, 20, LIGHTGRAY);
+        }
+
+        void Advance(float dt) {
+            speed += 0.0001f * dt * timeScale;
+            score += speed * dt * timeScale;
+            Vector3& position = Player().position;
+            position.x = lerp(position.x, targetX, 0.2f * dt * timeScale);
+            position.z -= speed * dt * timeScale;
+            camera.target.z = position.z;
+            camera.position.y = position.y + 7.0f;
+            camera.position.z = position.z + 10.0f + speed;
+            camera.position.x = lerp(camera.position.x, position.x, 0.1f * dt * timeScale);
+            camera.target.x = lerp(camera.target.x, camera.position.x, 0.2f * dt * timeScale);
+            camera.target.y = lerp(camera.target.y, position.y, 0.2f * dt * timeScale);
+
+            if (camera.fovy < 150.0f)
+                camera.fovy = 60.0f + speed;
+        }
+
+        void UpdateObstacles() {
+            Allocations::Scope scope(Allocations::Entities);
+
+            const Location player = Player();
+            const Bounds size = world.Get<Players>().Get<Bounds>(0);
+
+            // Collision and recycling in one pass: obstacles more than 10 units behind the player are moved to the
+            // back of the track in place instead of being destroyed and recreated.
+            world.Get<Obstacles>().EachChunk<Location, Bounds, Tint>([&](size_t count, Location* locations, Bounds* bounds, Tint* tints) {
+                for (size_t i = 0; i < count && !dead; i++) {
+                    if (Overlaps(player, size, locations[i], bounds[i])) {
+                        collisions++;
+                        if (!ghost) { dead = true; break; }
+                    }
+
+                    if (locations[i].position.z - player.position.z > 10) {
+                        Spawn spawn = track->Next(); hue = spawn.hue;
+                        locations[i].position = { spawn.lane, 0.0f, player.position.z - (maxObstacles * 10.0f) };
+                        tints[i].color = spawn.color;
+                    }
+                }
+            });
+        }
+
+        void Tick() {
+            Rebase();
+
+            const uint8_t held = autopilot || demo ? Steer() : heldKeys.load(std::memory_order_relaxed);
+            previousPosition = Player().position, previousCamera = camera;
+            timeScale = lerp(timeScale, (held & holdSlow) ? 25.0f : 75.0f, tickTime * 2.0f);
+
+            if (held & holdLeft) targetX -= speed * tickTime * timeScale;
+            if (held & holdRight) targetX += speed * tickTime * timeScale;
+            if (targetX > 4.0f) targetX = 4.0f;
+            if (targetX < -4.0f) targetX = -4.0f;
+
+            Advance(tickTime);
+            UpdateObstacles();
+            if (rewind) Record();
+        }
+
+        uint8_t Steer() {
+            const Location player = Player();
+            planner.Clear();
+
+            world.Get<Obstacles>().EachChunk<Location>([&](size_t count, Location* locations) {
+                for (size_t i = 0; i < count; i++) planner.Add(locations[i].position.z, locations[i].position.x, player.position.z);
+            });
+
+            int direction = planner.Plan(player.position.x, targetX, player.position.z, speed, speed * tickTime * timeScale);
+            return direction < 0 ? holdLeft : (direction > 0 ? holdRight : 0);
+        }
+
+        // Shifts the world back towards zero once the player is rebaseDistance out. The shift is a multiple of 1024
+        // taken towards zero, and everything that moves is within a few hundred units of the player, so each
+        // coordinate only shrinks in magnitude and the subtraction is exact: relative positions keep every bit.
+        void Rebase() {
+            if (Player().position.z > -rebaseDistance) return;
+
+            const float shift = std::trunc(Player().position.z / 1024.0f) * 1024.0f;
+            origin -= shift;
+
+            previousPosition.z -= shift;
+            camera.position.z -= shift, camera.target.z -= shift;
+            previousCamera.position.z -= shift, previousCamera.target.z -= shift;
+
+            // Covers the player and every obstacle, and whatever gets a Location later.
+            world.Each<Location>([&](Location& location) {
+                location.position.z -= shift;
+            });
+        }
+
+        // Runs as many fixed ticks as the elapsed frame time covers; the remainder is carried to the next frame
+        // and used to blend between the last two ticks when drawing.
+        void Simulate(float elapsed) {
+            accumulator += std::min(elapsed, maxTicksPerFrame * tickTime);
+
+            while (accumulator >= tickTime && !dead) {
+                Tick();
+                accumulator -= tickTime;
+            }
+        }
+
+        void Game(const WorldSnapshot& view) {
+            float alpha = view.alpha;
+            if (simulation.joinable()) alpha = std::fmin(std::fmax((float) ((Now() - view.tickClock) / tickTime), 0.0f), 1.0f);
+            if (view.dead || view.paused) alpha = 1.0f;
+
+            Vector3 position = {
+                lerp(view.previousPosition.x, view.position.x, alpha),
+                lerp(view.previousPosition.y, view.position.y, alpha),
+                lerp(view.previousPosition.z, view.position.z, alpha)
+            };
+
+            const Camera3D& previous = view.previousCamera;
+            Camera3D camera = view.camera;
+            camera.position = { lerp(previous.position.x, camera.position.x, alpha), lerp(previous.position.y, camera.position.y, alpha), lerp(previous.position.z, camera.position.z, alpha) };
+            camera.target = { lerp(previous.target.x, camera.target.x, alpha), lerp(previous.target.y, camera.target.y, alpha), lerp(previous.target.z, camera.target.z, alpha) };
+            camera.fovy = lerp(previous.fovy, camera.fovy, alpha);
+
+            Frustum frustum(camera, (float) width / height, 0.01f, cullDistance);
+            int drawn = 0, culled = 0;
+
+            // Obstacles light up towards white with the treble and on every onset, which the bloom then spreads.
+            const float glow = spectrum ? std::fmin(0.35f * audio.treble + 0.3f * audio.pulse, 1.0f) : 0.0f;
+
+            drawQueue.Begin(camera);
+            drawQueue.Cube(position, view.size, view.color);
+
+            for (const ObstacleState& obstacle : view.obstacles) {
+                if (!frustum.Contains(obstacle.position, { obstacle.size.x * 0.5f, obstacle.size.y * 0.5f, obstacle.size.z * 0.5f })) {
+                    culled++;
+                    continue;
+                }
+
+                Color color = obstacle.color;
+                if (glow > 0.0f) color = { (unsigned char) lerp(color.r, 255.0f, glow), (unsigned char) lerp(color.g, 255.0f, glow), (unsigned char) lerp(color.b, 255.0f, glow), color.a };
+
+                drawQueue.Cube(obstacle.position, obstacle.size, color);
+                drawn++;
+            }
+
+            // Only the stretch of floor between the camera and the cull distance can be seen.
+            float floorFront = std::fmin(position.z + 250.0f, camera.position.z), floorBack = std::fmax(position.z - 250.0f, camera.position.z - cullDistance);
+            if (floorFront > floorBack) drawQueue.Plane({0.0f, -1.0f, (floorFront + floorBack) * 0.5f}, {10, floorFront - floorBack}, {5, 5, 5, 255});
+
+            BeginMode3D(camera);
+            drawQueue.Submit();
+            EndMode3D();
+
+            profiler.Count("obstacles drawn", drawn);
+            profiler.Count("obstacles culled", culled);
+
+            Color hudColor = ColorFromHSV(view.hue - view.maxObstacles, 1, 1);
+            if (view.paused) DrawText("paused", 10, height - 10 - 30 - 50, 50, hudColor);
+            if (view.demo) DrawTextCentered("DEMO - press any key", -height / 2 + 40, 30, hudColor);
+            if (view.rewindable > 0.0f) {
+                char line[32];
+                std::snprintf(line, sizeof(line), "R: rewind (%.0f s)", view.rewindable);
+                DrawText(line, 10, height - 10 - 30 - 50 - 30, 20, hudColor);
+            }
+            if (IsKeyDown(KEY_Q)) DrawText((std::to_string(pacer.Fps()) + " FPS").c_str(), 10, 10, 25, hudColor);
+            DrawText((std::string("score: ") + std::to_string((int) view.score)).c_str(), 10, height - 10 - 30, 30, hudColor);
+        }
+
+        void GameOver(const WorldSnapshot& view) {
+            if (IsKeyDown(KEY_Q)) DrawText((std::to_string(pacer.Fps()) + " FPS").c_str(), 10, 10, 25, RED);
+            DrawText((std::string("score: ") + std::to_string((int) view.score)).c_str(), 10, height - 10 - 30, 30, LIGHTGRAY);
+            DrawTextCentered("GAME OVER", 0, 100, RED);
+            DrawTextCentered("press space to play again", 100 / 2 + 20 / 2, 20, LIGHTGRAY);
+            if (view.rewindable > 0.0f) DrawTextCentered("press R to rewind", 100 / 2 + 20 / 2 + 30, 20, LIGHTGRAY);
+        }
+};
+
+// Checks the FFT against a direct DFT and its SSE path against the scalar one, then plays `seconds` of a synthetic
+// 120 BPM track through the analysis: a decaying 55 Hz kick on every beat, noise hats on the off-beats and a quiet
+// two-note pad. The analysis has to find about one onset per kick and none anywhere else.
+int CheckSpectrum(double seconds) {
+    const int size = Spectrum::size, rate = 44100;
+    Fft fft(size);
+    std::vector<float> input(size), re(size), im(size), scalarRe(size), scalarIm(size);
+
+    for (int i = 0; i < size; i++) {
+        input[i] = (float) (TrackGenerator::Mix((uint64_t) i) >> 40) / (1 << 24) * 2.0f - 1.0f;
+        re[fft.Reversed(i)] = scalarRe[fft.Reversed(i)] = input[i];
+    }
+
+    fft.Transform(re.data(), im.data(), true);
+    fft.Transform(scalarRe.data(), scalarIm.data(), false);
+
+    double worst = 0.0, largest = 0.0;
+    for (int k = 0; k < size; k++) {
+        double directRe = 0.0, directIm = 0.0;
+        for (int n = 0; n < size; n++) {
+            const double angle = -2.0 * 3.14159265358979323846 * (double) ((int64_t) k * n % size) / size;
+            directRe += input[n] * std::cos(angle), directIm += input[n] * std::sin(angle);
+        }
+
+        worst = std::max(worst, std::hypot(re[k] - directRe, im[k] - directIm));
+        largest = std::max(largest, std::hypot(directRe, directIm));
+    }
+
+    const bool identical = std::memcmp(re.data(), scalarRe.data(), size * sizeof(float)) == 0 && std::memcmp(im.data(), scalarIm.data(), size * sizeof(float)) == 0;
+    std::printf("fft %d: max error %.3g of peak %.1f, SSE and scalar %s\n", size, worst, largest, identical ? "identical" : "DIFFER");
+
+    std::vector<float> track((size_t) (seconds * rate));
+    for (size_t i = 0; i < track.size(); i++) {
+        const double t = (double) i / rate, beat = std::fmod(t, 0.5), offbeat = std::fmod(t + 0.25, 0.5);
+        const double kick = 0.9 * std::exp(-beat * 18.0) * std::sin(2.0 * 3.14159265358979323846 * 55.0 * beat);
+        const double hat = 0.2 * std::exp(-offbeat * 60.0) * ((double) (TrackGenerator::Mix(i) >> 40) / (1 << 24) * 2.0 - 1.0);
+        const double pad = 0.05 * (std::sin(2.0 * 3.14159265358979323846 * 440.0 * t) + std::sin(2.0 * 3.14159265358979323846 * 554.4 * t));
+        track[i] = (float) (kick + hat + pad);
+    }
+
+    double vectorTime = 0.0, scalarTime = 0.0, bass = 0.0, mid = 0.0, treble = 0.0;
+    uint32_t onsets = 0;
+    int hops = 0;
+
+    for (int vectorised = 1; vectorised >= 0; vectorised--) {
+        Spectrum analysis(track, rate);
+        analysis.SetVectorised(vectorised);
+        const auto begin = std::chrono::steady_clock::now();
+
+        for (int64_t end = Spectrum::hop; end <= (int64_t) track.size(); end += Spectrum::hop) {
+            const AudioBands& bands = analysis.Analyse(end);
+            if (!vectorised) continue;
+            bass += bands.bass, mid += bands.mid, treble += bands.treble, onsets = bands.onsets, hops++;
+        }
+
+        (vectorised ? vectorTime : scalarTime) = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    const double expected = std::floor(seconds * 2.0);
+    const bool found = std::fabs(onsets - expected) <= std::max(2.0, expected * 0.05), accurate = worst < 1e-5 * largest;
+    const bool passed = found && accurate;
+#if defined(__SSE2__)
+    const bool consistent = identical;
+#else
+    const bool consistent = true;
+#endif
+
+    std::printf("%d hops: %.2f us per hop with SSE, %.2f us scalar (%.2fx); mean levels bass %.2f mid %.2f treble %.2f\n", hops,
+        vectorTime / hops, scalarTime / hops, scalarTime / vectorTime, bass / hops, mid / hops, treble / hops);
+    std::printf("%u onsets for %.0f kicks -> %s\n", onsets, expected, passed && consistent ? "passed" : "FAILED");
+    return passed && consistent ? 0 : 1;
+}
+
+// Hammers the snapshot triple buffer from a writer and a reader thread and checks that every snapshot the
+// reader sees is complete, internally consistent and never older than the one before it. After every `pace`
+// snapshots the writer waits for the reader to catch up, so the two overlap instead of the writer finishing
+// before the reader is scheduled, and a run in which the reader saw fewer than one snapshot in every 2 * pace
+// fails.
+int StressSnapshots(uint64_t count) {
+    constexpr uint64_t pace = 16;
+    TripleBuffer<WorldSnapshot> buffer;
+    std::atomic<bool> finished { false };
+    std::atomic<uint64_t> seen { 0 };
+    uint64_t observed = 0, torn = 0, last = 0;
+
+    std::thread writer([&] {
+        for (uint64_t sequence = 1; sequence <= count; sequence++) {
+            WorldSnapshot& snapshot = buffer.Back();
+            snapshot.sequence = sequence;
+            snapshot.obstacles.resize(16 + sequence % 48);
+
+            for (ObstacleState& obstacle : snapshot.obstacles)
+                obstacle.position = { 0.0f, 0.0f, -(float) sequence };
+
+            snapshot.score = (float) sequence, snapshot.runs = (int) sequence;
+            snapshot.check = sequence;
+            buffer.Publish();
+
+            if (sequence % pace == 0)
+                while (seen.load(std::memory_order_acquire) < sequence) std::this_thread::yield();
+        }
+
+        finished = true;
+    });
+
+    while (!finished || last != count) {
+        if (!buffer.Update()) { std::this_thread::yield(); continue; }
+        const WorldSnapshot& snapshot = buffer.Front();
+        bool consistent = !snapshot.Torn() && snapshot.sequence > last && snapshot.runs == (int) snapshot.sequence;
+        consistent = consistent && snapshot.obstacles.size() == 16 + snapshot.sequence % 48;
+
+        for (const ObstacleState& obstacle : snapshot.obstacles)
+            consistent = consistent && obstacle.position.z == -(float) snapshot.sequence;
+
+        if (!consistent) torn++;
+        last = snapshot.sequence, observed++;
+        seen.store(last, std::memory_order_release);
+    }
+
+    writer.join();
+    const uint64_t minimum = count / (2 * pace);
+    std::printf("snapshots: %llu published, %llu observed (at least %llu expected), %llu torn\n", (unsigned long long) count,
+        (unsigned long long) observed, (unsigned long long) minimum, (unsigned long long) torn);
+    return torn == 0 && observed >= minimum ? 0 : 1;
+}
+
+// Validates unrepaired random lane sequences in chunks at a range of fixed speeds and reports how often a
+// chunk has no way through under the point model and under the windowed one the generator uses, along with how
+// fast the windowed check and generation run. Then walks a short sequence the point model passes but no player
+// can clear.
+int ReportSolvability(uint64_t seed, uint64_t obstacles) {
+    const float speeds[] = { 0.15f, 0.5f, 1.0f, 1.5f, 2.0f, 3.0f, 4.0f, 6.0f, 8.0f, 12.0f };
+    const uint64_t chunks = std::max<uint64_t>(1, obstacles / TrackChunk::size);
+    JobPool pool;
+
+    std::printf("%-8s %-12s %-14s %-14s %-14s %s\n", "speed", "reach", "chunks", "point", "windowed", "Mobstacles/s");
+
+    for (float speed : speeds) {
+        const int steps = Solvability::ReachSteps(speed);
+        std::atomic<uint64_t> pointUnsolvable { 0 }, unsolvable { 0 }, checked { 0 };
+        double seconds = 0.0;
+
+        pool.ParallelFor(chunks, 4096, [&](size_t first, size_t last) {
+            uint64_t failed = 0;
+
+            for (size_t chunk = first; chunk < last; chunk++) {
+                uint64_t reachable = Solvability::all;
+
+                for (int i = 0; i < TrackChunk::size && reachable; i++)
+                    reachable = Solvability::Step(reachable, TrackGenerator::Lane(seed, (uint64_t) (speed * 1000.0f), (uint64_t) chunk * TrackChunk::size + i), steps);
+
+                failed += reachable == 0;
+            }
+
+            pointUnsolvable += failed;
+        });
+
+        auto begin = std::chrono::high_resolution_clock::now();
+
+        pool.ParallelFor(chunks, 4096, [&](size_t first, size_t last) {
+            uint64_t failed = 0, rows = 0;
+
+            for (size_t chunk = first; chunk < last; chunk++) {
+                Solvability::State state = Solvability::Anywhere();
+                bool passed = true;
+
+                for (int i = 0; i < TrackChunk::size && passed; i++, rows++)
+                    passed = Solvability::Pass(state, TrackGenerator::Lane(seed, (uint64_t) (speed * 1000.0f), (uint64_t) chunk * TrackChunk::size + i), speed);
+
+                failed += !passed;
+            }
+
+            unsolvable += failed, checked += rows;
+        });
+
+        seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+        std::printf("%-8.2f %-12.2f %-14llu %-14.6f %-14.6f %.1f\n", speed, steps * Solvability::resolution, (unsigned long long) chunks,
+            (double) pointUnsolvable / chunks, (double) unsolvable / chunks, checked / seconds / 1e6);
+    }
+
+    // Generation validates every obstacle inline and re-rolls the ones that would leave no way through, so time
+    // that too, on one core, over runs of 16384 obstacles from rest.
+    const uint64_t runLength = 16384;
+    Solvability::State generated;
+    int repaired = 0;
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t i = 0; i < obstacles; i++) {
+        if (i % runLength == 0) generated = Solvability::Begin();
+        TrackGenerator::SolvableLane(seed, i / runLength, i % runLength, generated, repaired);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+    std::printf("\ngeneration up to speed %.2f: %.1f Mobstacles/s on one core, %.2f%% re-rolled\n", Solvability::SpeedAt(std::min(obstacles, runLength) - 1),
+        obstacles / seconds / 1e6, 100.0 * repaired / std::max<uint64_t>(1, obstacles));
+
+    // From rest in the middle at speed 1: lane -1 sends the player right of x = 1, lane 1 right of x = 3, and
+    // lane 2 back left of x = 0 one row later. Crossing those 3.5 units from rest takes about 7.4 units of travel
+    // with a lag of 5, which the point model finds in the 10 between rows, but the player has to be across before
+    // lane 2's window opens, at most 5.69 units after lane 1's has closed.
+    const float tight[] = { -1.0f, 1.0f, 2.0f }, speed = 1.0f;
+    uint64_t reachable = Solvability::Start();
+    Solvability::State state = Solvability::Begin();
+    bool point = true, windowed = true;
+
+    for (float lane : tight) {
+        point = point && (reachable = Solvability::Step(reachable, lane, Solvability::ReachSteps(speed))) != 0;
+        windowed = windowed && Solvability::Pass(state, lane, speed);
+    }
+
+    std::printf("\nlanes -1, 1, 2 at speed 1 from the middle: point model %s, windowed model %s\n", point ? "accepts" : "rejects", windowed ? "accepts" : "rejects");
+    return point && !windowed ? 0 : 1;
+}
+
+// Sweeps `count` seeds starting at `first` across all cores and prints the K seeds closest to the middle of each
+// difficulty band. Bands are calibrated on the start of the range; after that seeds are measured and dropped a
+// block at a time, so memory stays at K seeds per band per job however long the sweep runs.
+int SearchSeeds(uint64_t first, uint64_t count, size_t k, int obstacles) {
+    JobPool pool;
+    SeedRanking ranking(k);
+    std::mutex mutex;
+
+    std::vector<SeedDifficulty> sample((size_t) std::min<uint64_t>(std::max<uint64_t>(count, 1), 20000));
+    pool.ParallelFor(sample.size(), 256, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) sample[i] = MeasureSeed(first + i, obstacles);
+    });
+    ranking.Calibrate(sample);
+
+    const uint64_t block = uint64_t(1) << 20;
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t done = 0; done < count; done += block) {
+        const uint64_t base = first + done;
+
+        pool.ParallelFor((size_t) std::min(block, count - done), 4096, [&](size_t from, size_t to) {
+            SeedRanking local = ranking;
+            local.Clear();
+
+            for (size_t i = from; i < to; i++) local.Offer(MeasureSeed(base + i, obstacles));
+
+            std::lock_guard<std::mutex> lock(mutex);
+            ranking.Merge(local);
+        });
+
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+        uint64_t searched = std::min(count, done + block);
+        std::fprintf(stderr, "%llu / %llu seeds, %.0f seeds/s\n", (unsigned long long) searched, (unsigned long long) count, searched / seconds);
+    }
+
+    std::printf("%d obstacles per seed, %llu seeds from %llu, %zu threads\n", obstacles, (unsigned long long) count, (unsigned long long) first, pool.Size());
+
+    for (int band = 0; band < SeedRanking::bands; band++) {
+        std::printf("\n%s [%.2f, %.2f)\n%-12s %8s %10s %10s %10s\n", SeedRanking::Name(band), ranking.Lower(band), ranking.Upper(band),
+            "seed", "score", "switching", "steering", "clusters");
+
+        for (const SeedDifficulty& difficulty : ranking.Best(band))
+            std::printf("%-12llu %8.3f %10.3f %10.3f %10.2f\n", (unsigned long long) difficulty.seed, difficulty.score, difficulty.switching,
+                difficulty.steering, difficulty.clusters);
+    }
+
+    return 0;
+}
+
+// Reads the optional number after the flag at argv[i] into `value`, leaving it alone when the next argument is
+// missing or another flag. False, after saying so, when it is there but isn't a non-negative number.
+bool NumberAfter(int argc, const char* argv[], int i, double& value) {
+    if (i + 1 >= argc || argv[i + 1][0] == '-') return true;
+
+    char* end = nullptr;
+    const double parsed = std::strtod(argv[i + 1], &end);
+    if (end == argv[i + 1] || *end != '\0' || !(parsed >= 0.0)) return std::printf("expected a number after %s, got %s\n", argv[i], argv[i + 1]), false;
+
+    value = parsed;
+    return true;
+}
+
+int main(int argc, const char* argv[]) {
+    App app;
+    bool golden = false, goldenUpdate = false, seeded = false;
+    unsigned seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+
+        if (argument == "--software-post") app.SetSoftwarePost(true);
+        else if (argument == "--headless") app.SetHeadless(true);
+        else if (argument == "--seed" && i + 1 < argc) app.SetSeed(seed = (unsigned) std::stoul(argv[++i])), seeded = true;
+        else if (argument == "--resolution" && i + 2 < argc) app.SetResolution(std::stoi(argv[i + 1]), std::stoi(argv[i + 2])), i += 2;
+        else if (argument == "--fps" && i + 1 < argc) app.SetFrameRate(std::stoi(argv[++i]));
+        else if (argument == "--no-power-saver") app.SetPowerSaver(false);
+        else if (argument == "--record") app.SetRecording(true);
+        else if (argument == "--post" && i + 1 < argc) {
+            std::string effects = argv[++i];
+            app.SetPostEffects(effects.find("bloom") != std::string::npos, effects.find("crt") != std::string::npos);
+        }
+        else if (argument == "--cull-distance" && i + 1 < argc) app.SetCullDistance(std::stof(argv[++i]));
+        else if (argument == "--update-goldens") goldenUpdate = true;
+        else if (argument == "--golden") golden = true;
+        else if (argument == "--compare-post") return app.ComparePostProcess(60);
+        else if (argument == "--solvability") {
+            double obstacles = 1e7;
+            return NumberAfter(argc, argv, i, obstacles) ? ReportSolvability(seeded ? seed : 1, (uint64_t) obstacles) : 1;
+        }
+        else if (argument == "--seed-search") {
+            double count = 1e6, k = 10;
+            if (!NumberAfter(argc, argv, i, count) || (i + 1 < argc && argv[i + 1][0] != '-' && !NumberAfter(argc, argv, i + 1, k))) return 1;
+            return SearchSeeds(seeded ? seed : 0, (uint64_t) count, (size_t) k, 512);
+        }
+        else if (argument == "--rebase-check") {
+            double distance = 1e7;
+            return NumberAfter(argc, argv, i, distance) ? App::CheckRebasing(seeded ? seed : 1, distance) : 1;
+        }
+        else if (argument == "--rewind-check") {
+            double seconds = 30.0;
+            return NumberAfter(argc, argv, i, seconds) ? App::CheckRewind(seeded ? seed : 1, seconds) : 1;
+        }
+        else if (argument == "--practice") app.SetPractice(i + 1 < argc && argv[i + 1][0] != '-' ? std::stod(argv[++i]) : 30.0);
+        else if (argument == "--telemetry" && i + 1 < argc) app.SetTelemetry(argv[++i]);
+        else if (argument == "--telemetry-read") return PrintTelemetry(i + 1 < argc ? argv[i + 1] : "telemetry");
+        else if (argument == "--broadcast")
+            app.SetBroadcast(i + 1 < argc && argv[i + 1][0] != '-' ? (uint16_t) std::stoul(argv[++i]) : SpectatorServer::defaultPort);
+        else if (argument == "--broadcast-on" && i + 1 < argc) {
+            uint32_t address = 0;
+            if (!Endpoint::ParseAddress(argv[++i], address)) return std::printf("expected --broadcast-on a.b.c.d, localhost or any\n"), 1;
+            app.SetBroadcastAddress(address);
+        }
+        else if (argument == "--spectate") {
+            Endpoint server { Endpoint::loopback, SpectatorServer::defaultPort };
+            if (i + 1 < argc && !Endpoint::Parse(argv[i + 1], server)) return std::printf("expected host:port, got %s\n", argv[i + 1]), 1;
+            return app.Spectate(server);
+        }
+        else if (argument == "--spectator-check") {
+            double seconds = 120.0;
+            return NumberAfter(argc, argv, i, seconds) ? App::CheckSpectator(seeded ? seed : 1, seconds) : 1;
+        }
+        else if (argument == "--spectrum-check") {
+            double seconds = 60.0;
+            return NumberAfter(argc, argv, i, seconds) ? CheckSpectrum(seconds) : 1;
+        }
+        else if (argument == "--autopilot") app.SetAutopilot(true);
+        else if (argument == "--attract" && i + 1 < argc) app.SetAttractDelay(std::stod(argv[++i]));
+        else if (argument == "--soak") {
+            double seconds = 3600.0;
+            return NumberAfter(argc, argv, i, seconds) ? app.Soak(seconds) : 1;
+        }
+        else if (argument == "--memory-check") {
+            double seconds = 60.0;
+            return NumberAfter(argc, argv, i, seconds) ? app.CheckMemoryGrowth(seconds) : 1;
+        }
+        else if (argument == "--stress-snapshots") {
+            double count = 1e6;
+            return NumberAfter(argc, argv, i, count) ? StressSnapshots((uint64_t) count) : 1;
+        }
+        else if (argument == "--benchmark") {
+            if (!seeded) app.SetSeed(1);
+            return app.Benchmark(i + 1 < argc && argv[i + 1][0] != '-' ? argv[i + 1] : "benchmark.json");
+        }
+        else if (argument == "--microbench") return app.RunMicrobenchmarks(i + 1 < argc ? argv[i + 1] : ""), 0;
+    }
+
+    if (golden || goldenUpdate) {
+        if (!seeded) app.SetSeed(1);
+        return app.RunGoldenSuite("res/golden", goldenUpdate, "golden_report.json");
+    }
+
     app.Run();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+
+#include <raylib/raylib.h>
+
+#include "Allocations.hpp"
+
+// Sizes of resources whose memory lives outside operator new: GPU textures and render targets, and audio
+// buffers decoded by raylib. Sizes are computed from the description when the resource is created.
+class MemoryBudget {
+    public:
+        enum Kind { Gpu, Audio };
+
+    private:
+        struct Resource {
+            std::string name;
+            Kind kind;
+            int64_t bytes;
+        };
+
+        std::vector<Resource> resources;
+        int64_t current[2] = {}, peak[2] = {};
+
+    public:
+        static int64_t TextureBytes(const Texture2D& texture) {
+            return (int64_t) GetPixelDataSize(texture.width, texture.height, texture.format);
+        }
+
+        // Colour plus depth when the target has one; raylib's depth renderbuffer is 24 bit, stored as 32.
+        static int64_t TargetBytes(const RenderTexture2D& target) {
+            return TextureBytes(target.texture) + (target.depth.id ? (int64_t) target.texture.width * target.texture.height * 4 : 0);
+        }
+
+        // raylib converts sounds to the device format, 32-bit float stereo, when loading them.
+        static int64_t SoundBytes(const Sound& sound) {
+            return (int64_t) sound.frameCount * 2 * 4;
+        }
+
+        // Registering a name again replaces its size, so resizable resources can be reported after each change.
+        void Track(const std::string& name, Kind kind, int64_t bytes) {
+            Release(name);
+            resources.push_back({ name, kind, bytes });
+            current[kind] += bytes, peak[kind] = std::max(peak[kind], current[kind]);
+        }
+
+        void Release(const std::string& name) {
+            for (size_t i = 0; i < resources.size(); i++) {
+                if (resources[i].name != name) continue;
+                current[resources[i].kind] -= resources[i].bytes;
+                resources.erase(resources.begin() + i);
+                return;
+            }
+        }
+
+        int64_t Current(Kind kind) const { return current[kind]; }
+        int64_t Peak(Kind kind) const { return peak[kind]; }
+
+        void Draw(int x, int y, int size, Color color) const {
+            char line[96];
+
+            auto print = [&](const char* name, int64_t now, int64_t high) {
+                std::snprintf(line, sizeof(line), "%s: %.1f / %.1f MB", name, now / 1048576.0, high / 1048576.0);
+                DrawText(line, x, y, size, color), y += size + 4;
+            };
+
+            print("heap", Allocations::Current(), Allocations::Peak());
+            for (int category = 0; category < Allocations::Categories; category++)
+                print(Allocations::Name((Allocations::Category) category), Allocations::Current((Allocations::Category) category), Allocations::Peak((Allocations::Category) category));
+
+            print("gpu", current[Gpu], peak[Gpu]);
+            print("audio", current[Audio], peak[Audio]);
+        }
+
+        void Dump(std::FILE* file) const {
+            std::fprintf(file, "%-24s %12s %12s\n", "heap", "current", "peak");
+            for (int category = 0; category < Allocations::Categories; category++)
+                std::fprintf(file, "  %-22s %12lld %12lld\n", Allocations::Name((Allocations::Category) category), (long long) Allocations::Current((Allocations::Category) category), (long long) Allocations::Peak((Allocations::Category) category));
+            std::fprintf(file, "  %-22s %12lld %12lld\n", "total", (long long) Allocations::Current(), (long long) Allocations::Peak());
+
+            for (int kind = Gpu; kind <= Audio; kind++) {
+                std::fprintf(file, "%-24s %12s\n", kind == Gpu ? "gpu" : "audio", "bytes");
+                for (const Resource& resource : resources)
+                    if (resource.kind == kind) std::fprintf(file, "  %-22s %12lld\n", resource.name.c_str(), (long long) resource.bytes);
+                std::fprintf(file, "  %-22s %12lld %12lld\n", "total", (long long) current[kind], (long long) peak[kind]);
+            }
+        }
+};
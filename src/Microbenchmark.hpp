@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <functional>
+#include <algorithm>
+
+#include "Allocations.hpp"
+
+// A small stand-in for Google Benchmark: `for (auto _ : state)` loops are timed with an auto-scaled
+// iteration count and reported as ns/op plus heap allocations/op.
+class Microbenchmark {
+    public:
+        class State {
+            private:
+                size_t iterations;
+
+            public:
+                const int64_t argument;
+
+                struct Value {
+                    ~Value() {}
+                };
+
+                struct Iterator {
+                    size_t remaining;
+                    bool operator!=(const Iterator& other) const { return remaining != other.remaining; }
+                    void operator++() { remaining--; }
+                    Value operator*() const { return {}; }
+                };
+
+                std::chrono::high_resolution_clock::time_point start;
+                uint64_t allocations = 0;
+
+                State(size_t iterations, int64_t argument) : iterations(iterations), argument(argument) {}
+
+                // Setup done before the loop starts is excluded from both the time and the allocation count.
+                Iterator begin() {
+                    allocations = Allocations::Count();
+                    start = std::chrono::high_resolution_clock::now();
+                    return { iterations };
+                }
+
+                Iterator end() const { return { 0 }; }
+        };
+
+        template <typename T>
+        static void DoNotOptimize(const T& value) {
+            asm volatile("" : : "r,m"(value) : "memory");
+        }
+
+    private:
+        struct Case {
+            std::string name;
+            std::function<void(State&)> body;
+            std::vector<int64_t> arguments;
+        };
+
+        std::vector<Case> cases;
+        const double minimumTime = 0.2;
+
+    public:
+        void Register(const std::string& name, std::function<void(State&)> body, std::vector<int64_t> arguments) {
+            cases.push_back({ name, std::move(body), std::move(arguments) });
+        }
+
+        void Run(const std::string& filter) {
+            std::printf("%-32s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "allocs/op");
+
+            for (const Case& test : cases) {
+                if (!filter.empty() && test.name.find(filter) == std::string::npos) continue;
+
+                for (int64_t argument : test.arguments) {
+                    size_t iterations = 1;
+                    double elapsed = 0.0;
+                    uint64_t allocations = 0;
+
+                    while (true) {
+                        State state(iterations, argument);
+                        test.body(state);
+                        elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - state.start).count();
+                        allocations = Allocations::Count() - state.allocations;
+
+                        if (elapsed >= minimumTime || iterations >= (size_t(1) << 40)) break;
+                        iterations = elapsed <= 0.0 ? iterations * 10 : (size_t) (iterations * std::min(10.0, 1.4 * minimumTime / elapsed)) + 1;
+                    }
+
+                    std::string label = test.name + "/" + std::to_string(argument);
+                    std::printf("%-32s %14zu %14.2f %14.3f\n", label.c_str(), iterations, elapsed * 1e9 / iterations, (double) allocations / iterations);
+                }
+            }
+        }
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+
+#if defined(_WIN32)
+// windows.h clashes with raylib's names, so only the one psapi call is declared.
+extern "C" {
+    struct ProcessMemoryCounters {
+        unsigned long cb, pageFaultCount;
+        size_t peakWorkingSetSize, workingSetSize, quotaPeakPagedPoolUsage, quotaPagedPoolUsage;
+        size_t quotaPeakNonPagedPoolUsage, quotaNonPagedPoolUsage, pagefileUsage, peakPagefileUsage;
+    };
+
+    __declspec(dllimport) void* __stdcall GetCurrentProcess(void);
+    __declspec(dllimport) int __stdcall K32GetProcessMemoryInfo(void* process, ProcessMemoryCounters* counters, unsigned long size);
+}
+#else
+#include <unistd.h>
+#endif
+
+// Resident set size of this process in bytes, or zero when the platform does not report it.
+inline int64_t ResidentBytes() {
+#if defined(_WIN32)
+    ProcessMemoryCounters counters = {};
+    counters.cb = sizeof(counters);
+    return K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? (int64_t) counters.workingSetSize : 0;
+#else
+    long pages = 0, resident = 0;
+    std::FILE* file = std::fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+
+    bool read = std::fscanf(file, "%ld %ld", &pages, &resident) == 2;
+    std::fclose(file);
+    return read ? (int64_t) resident * sysconf(_SC_PAGESIZE) : 0;
+#endif
+}
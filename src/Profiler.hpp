@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <raylib/raylib.h>
+
+class Profiler {
+    public:
+        struct Stage {
+            const char* name;
+            double last = 0.0, average = 0.0;
+            bool counter = false;
+        };
+
+        class Scope {
+            private:
+                Profiler& profiler;
+                const char* name;
+                std::chrono::high_resolution_clock::time_point start;
+
+            public:
+                Scope(Profiler& profiler, const char* name) : profiler(profiler), name(name), start(std::chrono::high_resolution_clock::now()) {}
+
+                ~Scope() {
+                    profiler.Record(name, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+                }
+        };
+
+    private:
+        std::vector<Stage> stages;
+        const double smoothing = 0.05;
+
+        Stage& Find(const char* name) {
+            for (Stage& stage : stages)
+                if (stage.name == name || std::strcmp(stage.name, name) == 0) return stage;
+
+            stages.push_back({ name });
+            return stages.back();
+        }
+
+    public:
+        // Stage names are expected to be string literals; only the pointer is kept.
+        void Record(const char* name, double milliseconds) {
+            Stage& stage = Find(name);
+            stage.average = stage.last == 0.0 && stage.average == 0.0 ? milliseconds : stage.average + (milliseconds - stage.average) * smoothing;
+            stage.last = milliseconds;
+        }
+
+        void Count(const char* name, double value) {
+            Stage& stage = Find(name);
+            stage.counter = true, stage.last = value, stage.average = value;
+        }
+
+        const Stage* Get(const char* name) const {
+            for (const Stage& stage : stages)
+                if (stage.name == name || std::strcmp(stage.name, name) == 0) return &stage;
+
+            return nullptr;
+        }
+
+        const std::vector<Stage>& Stages() const {
+            return stages;
+        }
+
+        void Draw(int x, int y, int size, Color color) const {
+            char line[96];
+
+            for (const Stage& stage : stages) {
+                if (stage.counter) std::snprintf(line, sizeof(line), "%s: %.0f", stage.name, stage.last);
+                else std::snprintf(line, sizeof(line), "%s: %.2f ms", stage.name, stage.average);
+                DrawText(line, x, y, size, color), y += size + 4;
+            }
+        }
+};
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+
+#include <raylib/raylib.h>
+
+#include "GpuTimer.hpp"
+
+// rlgl entry points raylib.h does not declare; LoadRenderTexture always attaches a depth buffer.
+extern "C" {
+    unsigned int rlLoadFramebuffer(int width, int height);
+    void rlFramebufferAttach(unsigned int fboId, unsigned int texId, int attachType, int texType, int mipLevel);
+    bool rlFramebufferComplete(unsigned int id);
+    unsigned int rlLoadTexture(const void* data, int width, int height, int format, int mipmapCount);
+    void rlEnableFramebuffer(unsigned int id);
+    void rlDisableFramebuffer(void);
+    void rlDrawRenderBatchActive(void);
+}
+
+// Render texture with only a colour attachment, for passes that draw full screen quads.
+inline RenderTexture2D LoadColorTarget(int width, int height, int format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+    RenderTexture2D target = {};
+    target.id = rlLoadFramebuffer(width, height);
+    if (target.id == 0) return target;
+
+    rlEnableFramebuffer(target.id);
+    target.texture = { rlLoadTexture(nullptr, width, height, format, 1), width, height, 1, format };
+    rlFramebufferAttach(target.id, target.texture.id, 0, 100, 0);
+    if (!rlFramebufferComplete(target.id)) TraceLog(LOG_WARNING, "FBO: [ID %i] Colour target is not complete", target.id);
+    rlDisableFramebuffer();
+
+    return target;
+}
+
+// Post-processing passes declared by their inputs and output. Compile() skips disabled passes by forwarding
+// their input, culls passes nobody reads, and places transient targets in a pool so targets whose lifetimes
+// do not overlap share one texture. Imported targets are owned by the caller; a null one is the screen.
+class RenderGraph {
+    public:
+        using Handle = int;
+        using Execute = std::function<void(const std::vector<Texture2D>& inputs)>;
+
+        struct Desc {
+            int width = 0, height = 0, format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+
+            bool operator==(const Desc& other) const {
+                return width == other.width && height == other.height && format == other.format;
+            }
+        };
+
+    private:
+        struct Resource {
+            std::string name;
+            Desc desc;
+            bool imported = false;
+            RenderTexture2D* external = nullptr;
+            int physical = -1, lastUse = -1;
+        };
+
+        struct Pass {
+            std::string name;
+            std::vector<Handle> inputs;
+            Handle output;
+            Execute execute;
+            bool enabled = true, live = false, copy = false;
+            std::vector<Handle> resolved;
+            std::vector<Texture2D> bound;
+            double milliseconds = 0.0;
+            GpuTimer timer;
+        };
+
+        struct Physical {
+            RenderTexture2D target;
+            Desc desc;
+            bool used = false;
+        };
+
+        std::vector<Resource> resources;
+        std::vector<Pass> passes;
+        std::vector<Physical> pool;
+        bool compiled = false;
+
+        Texture2D TextureOf(Handle handle) const {
+            const Resource& resource = resources[handle];
+            if (resource.imported) return resource.external ? resource.external->texture : Texture2D {};
+            return pool[resource.physical].target.texture;
+        }
+
+        int Acquire(const Desc& desc) {
+            for (size_t i = 0; i < pool.size(); i++)
+                if (!pool[i].used && pool[i].desc == desc) return pool[i].used = true, (int) i;
+
+            pool.push_back({ LoadColorTarget(desc.width, desc.height, desc.format), desc, true });
+            return (int) pool.size() - 1;
+        }
+
+    public:
+        // Targets are GPU resources, so this has to run before the window closes.
+        void Release() {
+            for (Physical& physical : pool) UnloadRenderTexture(physical.target);
+            for (Pass& pass : passes) pass.timer.Release();
+            pool.clear(), compiled = false;
+        }
+
+        Handle Import(const std::string& name, RenderTexture2D* target) {
+            Resource resource;
+            resource.name = name, resource.imported = true, resource.external = target;
+            resources.push_back(resource);
+            return (Handle) resources.size() - 1;
+        }
+
+        Handle Create(const std::string& name, const Desc& desc) {
+            Resource resource;
+            resource.name = name, resource.desc = desc;
+            resources.push_back(resource);
+            compiled = false;
+            return (Handle) resources.size() - 1;
+        }
+
+        // Imported targets can be swapped between executions without recompiling.
+        void Bind(Handle handle, RenderTexture2D* target) {
+            resources[handle].external = target;
+        }
+
+        // Passes run in the order they are added, and may only read what an earlier pass or an import provides.
+        void AddPass(const std::string& name, const std::vector<Handle>& inputs, Handle output, Execute execute) {
+            Pass pass;
+            pass.name = name, pass.inputs = inputs, pass.output = output, pass.execute = std::move(execute);
+            passes.push_back(std::move(pass));
+            compiled = false;
+        }
+
+        // A disabled pass hands its first input through; if it writes an import the input is copied instead.
+        void SetEnabled(const std::string& name, bool enabled) {
+            for (Pass& pass : passes)
+                if (pass.name == name && pass.enabled != enabled) pass.enabled = enabled, compiled = false;
+        }
+
+        void Compile() {
+            std::vector<Handle> alias(resources.size());
+            for (size_t i = 0; i < alias.size(); i++) alias[i] = (Handle) i;
+
+            for (Pass& pass : passes) {
+                pass.resolved.clear();
+                for (Handle input : pass.inputs) pass.resolved.push_back(alias[input]);
+
+                pass.copy = !pass.enabled && resources[pass.output].imported && !pass.resolved.empty();
+                pass.live = pass.enabled || pass.copy;
+                if (!pass.live && !pass.resolved.empty()) alias[pass.output] = pass.resolved[0];
+            }
+
+            std::vector<bool> needed(resources.size(), false);
+            for (size_t i = 0; i < resources.size(); i++) needed[i] = resources[i].imported;
+
+            for (size_t i = passes.size(); i-- > 0;) {
+                Pass& pass = passes[i];
+                pass.live = pass.live && needed[pass.output];
+                if (pass.live) for (Handle input : pass.resolved) needed[input] = true;
+            }
+
+            for (Resource& resource : resources) resource.physical = -1, resource.lastUse = -1;
+            for (size_t i = 0; i < passes.size(); i++)
+                if (passes[i].live) for (Handle input : passes[i].resolved) resources[input].lastUse = (int) i;
+
+            for (Physical& physical : pool) physical.used = false;
+
+            for (size_t i = 0; i < passes.size(); i++) {
+                Pass& pass = passes[i];
+                if (!pass.live) continue;
+
+                Resource& output = resources[pass.output];
+                if (!output.imported && output.physical < 0) output.physical = Acquire(output.desc);
+
+                // Inputs are released after the output is placed so a pass never reads the texture it writes.
+                for (Handle input : pass.resolved) {
+                    Resource& resource = resources[input];
+                    if (!resource.imported && resource.lastUse == (int) i && resource.physical >= 0) pool[resource.physical].used = false;
+                }
+            }
+
+            std::vector<bool> referenced(pool.size(), false);
+            for (const Resource& resource : resources)
+                if (resource.physical >= 0) referenced[resource.physical] = true;
+
+            std::vector<Physical> kept;
+            std::vector<int> remap(pool.size(), -1);
+
+            for (size_t i = 0; i < pool.size(); i++) {
+                if (!referenced[i]) { UnloadRenderTexture(pool[i].target); continue; }
+                remap[i] = (int) kept.size();
+                kept.push_back(pool[i]);
+            }
+
+            pool.swap(kept);
+            for (Resource& resource : resources)
+                if (resource.physical >= 0) resource.physical = remap[resource.physical];
+
+            compiled = true;
+        }
+
+        // Runs every live pass. A pass that draws to the screen leaves drawing open for the caller to present.
+        void Run() {
+            if (!compiled) Compile();
+
+            for (Pass& pass : passes) {
+                if (!pass.live) continue;
+                auto begin = std::chrono::high_resolution_clock::now();
+
+                pass.bound.clear();
+                for (Handle input : pass.resolved) pass.bound.push_back(TextureOf(input));
+
+                const Resource& output = resources[pass.output];
+                RenderTexture2D* target = output.imported ? output.external : &pool[output.physical].target;
+
+                pass.timer.Begin();
+                if (target) BeginTextureMode(*target);
+                else BeginDrawing();
+
+                if (pass.copy) {
+                    const Texture2D& texture = pass.bound[0];
+                    DrawTextureRec(texture, { 0, 0, (float) texture.width, (float) -texture.height }, { 0, 0 }, WHITE);
+                } else {
+                    pass.execute(pass.bound);
+                }
+
+                // raylib batches draws, so a pass to the screen is flushed here to keep its GPU work inside the timer.
+                if (target) EndTextureMode();
+                else rlDrawRenderBatchActive();
+                pass.timer.End();
+                pass.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+            }
+        }
+
+        // CPU time spent submitting the named pass in the last Run(), zero when it did not run.
+        double PassTime(const std::string& name) const {
+            for (const Pass& pass : passes)
+                if (pass.name == name) return pass.live ? pass.milliseconds : 0.0;
+
+            return 0.0;
+        }
+
+        // GPU time of the named pass a few frames ago, zero without timer queries.
+        double GpuTime(const std::string& name) const {
+            for (const Pass& pass : passes)
+                if (pass.name == name) return pass.live ? pass.timer.Milliseconds() : 0.0;
+
+            return 0.0;
+        }
+
+        size_t Targets() const {
+            return pool.size();
+        }
+
+        size_t Bytes() const {
+            size_t total = 0;
+            for (const Physical& physical : pool) total += (size_t) physical.desc.width * physical.desc.height * 4;
+            return total;
+        }
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <raylib/raylib.h>
+
+#include "TrackGenerator.hpp"
+
+// Scalar simulation state of one tick. The previous position and camera are not kept: they only blend the tick
+// before into the next frame, and a restored tick starts a fresh blend.
+struct RewindFrame {
+    Vector3 position;
+    Camera3D camera;
+    double score, origin;
+    float speed, timeScale, targetX;
+    int hue, cursor;
+    bool hueState, dead;
+};
+
+struct RewindObstacle {
+    Vector3 position;
+    Color color;
+};
+
+// Keeps the last few seconds of a run so it can be put back to any recent tick. History is split into segments
+// of `interval` ticks, each opening with a keyframe of every obstacle. Every tick stores its scalar state plus the
+// obstacles that differ from the tick before, which is usually none since obstacles only move when recycled. A
+// rebase shifts every obstacle at once, so it is stored as the change in origin instead of as obstacle changes.
+// Restoring copies one keyframe and applies at most one segment of changes, however far back the tick is.
+class RewindBuffer {
+    private:
+        struct Change {
+            uint32_t index;
+            RewindObstacle obstacle;
+        };
+
+        // Containers are cleared rather than freed when a segment is reused, so recording stops allocating once
+        // the ring has gone round once.
+        struct Segment {
+            uint64_t first = 0;
+            std::vector<RewindObstacle> keyframe;
+            std::vector<RewindFrame> frames;
+            std::vector<uint32_t> changeEnds;
+            std::vector<Change> changes;
+            std::vector<uint16_t> chunkOf;
+            std::vector<TrackChunk> chunks;
+        };
+
+        std::vector<Segment> segments;
+        const size_t interval;
+        size_t oldest = 0, count = 0;
+        uint64_t next = 0;
+
+        // Obstacles at the newest tick, which the next delta is taken against.
+        std::vector<RewindObstacle> last;
+
+        Segment& At(size_t i) {
+            return segments[(oldest + i) % segments.size()];
+        }
+
+        const Segment& At(size_t i) const {
+            return segments[(oldest + i) % segments.size()];
+        }
+
+        // Applies a rebase between two ticks the same way App::Rebase does; both sides are exact in float.
+        static void Shift(std::vector<RewindObstacle>& obstacles, double from, double to) {
+            if (from == to) return;
+            const float shift = (float) (to - from);
+            for (RewindObstacle& obstacle : obstacles) obstacle.position.z += shift;
+        }
+
+    public:
+        // One segment more than the window, so at least `seconds` of history survive the oldest being dropped.
+        // The per tick parts are reserved up front, so the buffer's size is known before the run starts.
+        RewindBuffer(double seconds, double rate, size_t interval = 240)
+            : segments((size_t) std::ceil(seconds * rate / interval) + 1), interval(interval) {
+            for (Segment& segment : segments)
+                segment.frames.reserve(interval), segment.changeEnds.reserve(interval), segment.chunkOf.reserve(interval), segment.chunks.reserve(2);
+        }
+
+        void Clear() {
+            oldest = count = 0, next = 0;
+            last.clear();
+        }
+
+        bool Empty() const {
+            return count == 0;
+        }
+
+        // Tick numbers count up from the first Capture() after Clear().
+        uint64_t Oldest() const {
+            return count ? At(0).first : next;
+        }
+
+        uint64_t Newest() const {
+            return next - 1;
+        }
+
+        void Capture(const RewindFrame& frame, const TrackChunk& chunk, const std::vector<RewindObstacle>& obstacles) {
+            Segment* segment = count ? &At(count - 1) : nullptr;
+
+            if (!segment || segment->frames.size() == interval || obstacles.size() != last.size()) {
+                if (count == segments.size()) oldest = (oldest + 1) % segments.size(), count--;
+
+                segment = &At(count++);
+                segment->first = next;
+                segment->keyframe.assign(obstacles.begin(), obstacles.end());
+                segment->frames.clear(), segment->changeEnds.clear(), segment->changes.clear();
+                segment->chunkOf.clear(), segment->chunks.clear();
+                last.assign(obstacles.begin(), obstacles.end());
+            } else {
+                Shift(last, segment->frames.back().origin, frame.origin);
+
+                for (size_t i = 0; i < obstacles.size(); i++) {
+                    if (std::memcmp(&obstacles[i], &last[i], sizeof(RewindObstacle)) == 0) continue;
+                    segment->changes.push_back({ (uint32_t) i, obstacles[i] });
+                    last[i] = obstacles[i];
+                }
+            }
+
+            if (segment->chunks.empty() || segment->chunks.back().run != chunk.run || segment->chunks.back().index != chunk.index)
+                segment->chunks.push_back(chunk);
+
+            segment->frames.push_back(frame);
+            segment->changeEnds.push_back((uint32_t) segment->changes.size());
+            segment->chunkOf.push_back((uint16_t) (segment->chunks.size() - 1));
+            next++;
+        }
+
+        // Makes `tick` the newest state and drops everything recorded after it, so capturing carries on from there.
+        // Returns false when the tick has already left the buffer or was never recorded.
+        bool Restore(uint64_t tick) {
+            if (count == 0 || tick < Oldest() || tick > Newest()) return false;
+
+            size_t index = count - 1;
+            while (At(index).first > tick) index--;
+
+            Segment& segment = At(index);
+            const size_t frame = (size_t) (tick - segment.first);
+            last.assign(segment.keyframe.begin(), segment.keyframe.end());
+
+            for (size_t i = 1; i <= frame; i++) {
+                Shift(last, segment.frames[i - 1].origin, segment.frames[i].origin);
+                for (uint32_t c = segment.changeEnds[i - 1]; c < segment.changeEnds[i]; c++)
+                    last[segment.changes[c].index] = segment.changes[c].obstacle;
+            }
+
+            segment.frames.resize(frame + 1), segment.changeEnds.resize(frame + 1), segment.chunkOf.resize(frame + 1);
+            segment.changes.resize(segment.changeEnds.back());
+            segment.chunks.resize(segment.chunkOf.back() + 1);
+            count = index + 1, next = tick + 1;
+            return true;
+        }
+
+        // The newest state: after Restore(), the tick that was restored.
+        const RewindFrame& Frame() const {
+            return At(count - 1).frames.back();
+        }
+
+        const TrackChunk& Chunk() const {
+            return At(count - 1).chunks.back();
+        }
+
+        const std::vector<RewindObstacle>& Obstacles() const {
+            return last;
+        }
+
+        // Bytes held, including capacity kept for reuse.
+        size_t Bytes() const {
+            size_t bytes = last.capacity() * sizeof(RewindObstacle);
+
+            for (const Segment& segment : segments) {
+                bytes += segment.keyframe.capacity() * sizeof(RewindObstacle) + segment.frames.capacity() * sizeof(RewindFrame);
+                bytes += segment.changeEnds.capacity() * sizeof(uint32_t) + segment.changes.capacity() * sizeof(Change);
+                bytes += segment.chunkOf.capacity() * sizeof(uint16_t) + segment.chunks.capacity() * sizeof(TrackChunk);
+            }
+
+            return bytes;
+        }
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "Solvability.hpp"
+#include "TrackGenerator.hpp"
+
+// Difficulty of the first run a seed produces, from the same lane sequence the track generator would spawn.
+// The player is walked through it greedily: it stays put until an obstacle would hit it, then takes the shorter
+// legal sidestep. `switching` is the mean sidestep per obstacle, `steering` the mean sidestep divided by the time
+// until that obstacle at the speed it is reached at (units per second), and `clusters` counts streaks of three or
+// more obstacles in a row that each force a sidestep, per hundred obstacles.
+struct SeedDifficulty {
+    uint64_t seed = 0;
+    float switching = 0.0f, steering = 0.0f, clusters = 0.0f, score = 0.0f;
+};
+
+inline SeedDifficulty MeasureSeed(uint64_t seed, int obstacles) {
+    Solvability::State reachable = Solvability::Begin();
+    int repaired = 0, streak = 0, clusters = 0;
+    float x = 0.0f;
+    double switching = 0.0, steering = 0.0;
+
+    for (int i = 0; i < obstacles; i++) {
+        const float lane = TrackGenerator::SolvableLane(seed, 0, (uint64_t) i, reachable, repaired);
+        float step = 0.0f;
+
+        if (std::fabs(x - lane) <= Solvability::half) {
+            const float left = lane - Solvability::half - Solvability::resolution, right = lane + Solvability::half + Solvability::resolution;
+            float next = right > 4.0f || (left >= -4.0f && x - left < right - x) ? left : right;
+            step = std::fabs(next - x), x = next;
+        }
+
+        // The player covers one row spacing in rowSpacing / (speed * 75) seconds at full time scale.
+        switching += step;
+        steering += step * Solvability::SpeedAt((uint64_t) i) * 75.0f / Solvability::rowSpacing;
+        streak = step > 0.0f ? streak + 1 : 0;
+        clusters += streak == 3;
+    }
+
+    SeedDifficulty result;
+    result.seed = seed;
+    result.switching = (float) (switching / obstacles);
+    result.steering = (float) (steering / obstacles);
+    result.clusters = clusters * 100.0f / obstacles;
+    return result;
+}
+
+// Scores seeds against a calibration sample and keeps, for each of a few difficulty bands, the K seeds closest to
+// the middle of that band. Band edges are quantiles of the sample, so every band is about equally common. Only
+// K seeds per band are ever held, however many are offered, and merging rankings is order independent.
+class SeedRanking {
+    public:
+        static constexpr int bands = 5;
+
+    private:
+        double mean[3] = {}, deviation[3] = { 1.0, 1.0, 1.0 };
+        float edges[bands + 1] = {}, centres[bands] = {};
+        size_t k;
+        std::vector<SeedDifficulty> best[bands];
+
+        static void Metrics(const SeedDifficulty& difficulty, double out[3]) {
+            out[0] = difficulty.switching, out[1] = difficulty.steering, out[2] = difficulty.clusters;
+        }
+
+        // Heap order puts the seed furthest from the band centre on top, so it is the one evicted.
+        bool Closer(int band, const SeedDifficulty& a, const SeedDifficulty& b) const {
+            float da = std::fabs(a.score - centres[band]), db = std::fabs(b.score - centres[band]);
+            return da != db ? da < db : a.seed < b.seed;
+        }
+
+    public:
+        explicit SeedRanking(size_t k) : k(k) {}
+
+        static const char* Name(int band) {
+            static const char* const names[bands] = { "easy", "moderate", "hard", "very hard", "extreme" };
+            return names[band];
+        }
+
+        void Calibrate(std::vector<SeedDifficulty> sample) {
+            for (int m = 0; m < 3; m++) {
+                double sum = 0.0, squares = 0.0, values[3];
+
+                for (const SeedDifficulty& difficulty : sample) Metrics(difficulty, values), sum += values[m], squares += values[m] * values[m];
+
+                mean[m] = sum / sample.size();
+                deviation[m] = std::max(1e-9, std::sqrt(std::max(0.0, squares / sample.size() - mean[m] * mean[m])));
+            }
+
+            for (SeedDifficulty& difficulty : sample) Score(difficulty);
+            std::sort(sample.begin(), sample.end(), [](const SeedDifficulty& a, const SeedDifficulty& b) { return a.score < b.score; });
+
+            auto quantile = [&](double q) { return sample[std::min(sample.size() - 1, (size_t) (q * sample.size()))].score; };
+            for (int band = 0; band <= bands; band++) edges[band] = quantile((double) band / bands);
+            for (int band = 0; band < bands; band++) centres[band] = quantile((band + 0.5) / bands);
+            edges[0] = -INFINITY, edges[bands] = INFINITY;
+        }
+
+        // The mean of the three metrics in standard deviations from the sample mean.
+        void Score(SeedDifficulty& difficulty) const {
+            double values[3], score = 0.0;
+            Metrics(difficulty, values);
+            for (int m = 0; m < 3; m++) score += (values[m] - mean[m]) / deviation[m];
+            difficulty.score = (float) (score / 3.0);
+        }
+
+        int Band(float score) const {
+            int band = 0;
+            while (band + 1 < bands && score >= edges[band + 1]) band++;
+            return band;
+        }
+
+        void Offer(SeedDifficulty difficulty) {
+            Score(difficulty);
+            const int band = Band(difficulty.score);
+            std::vector<SeedDifficulty>& heap = best[band];
+            auto order = [&](const SeedDifficulty& a, const SeedDifficulty& b) { return Closer(band, a, b); };
+
+            if (heap.size() < k) {
+                heap.push_back(difficulty), std::push_heap(heap.begin(), heap.end(), order);
+            } else if (k > 0 && Closer(band, difficulty, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), order);
+                heap.back() = difficulty, std::push_heap(heap.begin(), heap.end(), order);
+            }
+        }
+
+        void Merge(const SeedRanking& other) {
+            for (int band = 0; band < bands; band++)
+                for (const SeedDifficulty& difficulty : other.best[band]) Offer(difficulty);
+        }
+
+        float Lower(int band) const { return edges[band]; }
+        float Upper(int band) const { return edges[band + 1]; }
+
+        // Closest to the band centre first.
+        std::vector<SeedDifficulty> Best(int band) const {
+            std::vector<SeedDifficulty> sorted = best[band];
+            std::sort(sorted.begin(), sorted.end(), [&](const SeedDifficulty& a, const SeedDifficulty& b) { return Closer(band, a, b); });
+            return sorted;
+        }
+
+        void Clear() {
+            for (std::vector<SeedDifficulty>& heap : best) heap.clear();
+        }
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "JobPool.hpp"
+
+// CPU port of shaders/bloom.frag followed by shaders/crt.frag, working on RGBA8 frames in texture storage order.
+class SoftwarePostProcess {
+    private:
+        static constexpr int range = 5, step = 6, rowGrain = 16;
+
+        JobPool& pool;
+        int width, height;
+        std::vector<uint16_t> rowSums;
+        std::vector<uint8_t> bloomed;
+        std::vector<int32_t> crtSource;
+        std::vector<uint8_t> crtFactor;
+        uint16_t factorScale = 0, blurScale = 455;
+
+        static int Wrap(int value, int size) {
+            return ((value % size) + size) % size;
+        }
+
+        static float ScanLine(float uv, float resolution, float opacity) {
+            float intensity = std::sin(uv * resolution * 3.1415926538f * 2.0f);
+            return std::pow(((0.5f * intensity) + 0.5f) * 0.9f + 0.1f, opacity);
+        }
+
+        // The CRT pass only depends on the resolution, so its remap and intensity terms are baked once.
+        void BuildCrtTable(float curvature, float scanLineOpacity, float vignetteOpacity, float vignetteRoundness, float brightness) {
+            crtSource.resize((size_t) width * height);
+            crtFactor.resize((size_t) width * height);
+
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    size_t i = (size_t) y * width + x;
+                    float u = (x + 0.5f) / width * 2.0f - 1.0f, v = (y + 0.5f) / height * 2.0f - 1.0f;
+                    float offsetX = std::fabs(v) / curvature, offsetY = std::fabs(u) / curvature;
+                    u = (u + u * offsetX * offsetX) * 0.5f + 0.5f;
+                    v = (v + v * offsetY * offsetY) * 0.5f + 0.5f;
+
+                    if (u < 0.0f || v < 0.0f || u > 1.0f || v > 1.0f) {
+                        crtSource[i] = -1, crtFactor[i] = 0;
+                        continue;
+                    }
+
+                    float vignette = std::pow((width / vignetteRoundness) * u * v * (1.0f - u) * (1.0f - v), vignetteOpacity);
+                    float factor = std::fmin(std::fmax(vignette, 0.0f), 1.0f) * brightness;
+                    factor *= ScanLine(u, (float) height, scanLineOpacity) * ScanLine(v, (float) width, scanLineOpacity);
+
+                    crtSource[i] = std::min((int) (v * height), height - 1) * width + std::min((int) (u * width), width - 1);
+                    crtFactor[i] = (uint8_t) std::lround(std::fmin(factor / brightness, 1.0f) * 255.0f);
+                }
+            }
+
+            factorScale = (uint16_t) std::lround(brightness / 255.0f * 65536.0f);
+        }
+
+        void HorizontalRows(const uint8_t* src, int begin, int end) {
+            const int edge = range * step;
+
+            for (int y = begin; y < end; y++) {
+                const uint8_t* row = src + (size_t) y * width * 4;
+                uint16_t* out = rowSums.data() + (size_t) y * width * 4;
+                int x = 0;
+
+                auto scalar = [&](int x) {
+                    uint32_t sum[4] = {};
+
+                    for (int i = -range; i <= range; i++) {
+                        const uint8_t* pixel = row + Wrap(x + i * step, width) * 4;
+                        for (int c = 0; c < 4; c++) sum[c] += pixel[c];
+                    }
+
+                    for (int c = 0; c < 4; c++) out[x * 4 + c] = (uint16_t) sum[c];
+                };
+
+                for (; x < edge && x < width; x++) scalar(x);
+#if defined(__SSE2__)
+                const __m128i zero = _mm_setzero_si128();
+
+                for (; x + 4 <= width - edge; x += 4) {
+                    __m128i lo = zero, hi = zero;
+
+                    for (int i = -range; i <= range; i++) {
+                        __m128i pixels = _mm_loadu_si128((const __m128i*) (row + (x + i * step) * 4));
+                        lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(pixels, zero));
+                        hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(pixels, zero));
+                    }
+
+                    _mm_storeu_si128((__m128i*) (out + x * 4), lo);
+                    _mm_storeu_si128((__m128i*) (out + x * 4 + 8), hi);
+                }
+#endif
+                for (; x < width; x++) scalar(x);
+            }
+        }
+
+        void VerticalRows(const uint8_t* src, int begin, int end) {
+            const uint16_t* rows[range * 2 + 1];
+            const int count = width * 4;
+
+            for (int y = begin; y < end; y++) {
+                for (int i = -range; i <= range; i++)
+                    rows[i + range] = rowSums.data() + (size_t) Wrap(y + i * step, height) * count;
+
+                const uint8_t* source = src + (size_t) y * count;
+                uint8_t* out = bloomed.data() + (size_t) y * count;
+                int c = 0;
+#if defined(__SSE2__)
+                const __m128i bias = _mm_set1_epi16(72), scale = _mm_set1_epi16((short) blurScale);
+
+                for (; c + 16 <= count; c += 16) {
+                    __m128i lo = bias, hi = bias;
+
+                    for (int i = 0; i < range * 2 + 1; i++) {
+                        lo = _mm_add_epi16(lo, _mm_loadu_si128((const __m128i*) (rows[i] + c)));
+                        hi = _mm_add_epi16(hi, _mm_loadu_si128((const __m128i*) (rows[i] + c + 8)));
+                    }
+
+                    __m128i blur = _mm_packus_epi16(_mm_mulhi_epu16(lo, scale), _mm_mulhi_epu16(hi, scale));
+                    __m128i pixels = _mm_loadu_si128((const __m128i*) (source + c));
+                    _mm_storeu_si128((__m128i*) (out + c), _mm_adds_epu8(pixels, blur));
+                }
+#endif
+                for (; c < count; c++) {
+                    uint32_t sum = 72;
+                    for (int i = 0; i < range * 2 + 1; i++) sum += rows[i][c];
+                    out[c] = (uint8_t) std::min<uint32_t>(255, source[c] + ((sum * blurScale) >> 16));
+                }
+            }
+        }
+
+        void CrtRows(uint8_t* dst, int begin, int end) {
+            const uint32_t* source = (const uint32_t*) bloomed.data();
+            uint32_t* out = (uint32_t*) dst;
+            const uint32_t opaque = 0xFF000000u;
+
+            for (int y = begin; y < end; y++) {
+                size_t i = (size_t) y * width, last = i + width;
+#if defined(__SSE2__)
+                const __m128i zero = _mm_setzero_si128(), scale = _mm_set1_epi16((short) factorScale);
+                const __m128i alpha = _mm_set1_epi32((int) opaque);
+
+                for (; i + 4 <= last; i += 4) {
+                    const int32_t* index = crtSource.data() + i;
+                    __m128i pixels = _mm_set_epi32(
+                        index[3] < 0 ? 0 : (int) source[index[3]], index[2] < 0 ? 0 : (int) source[index[2]],
+                        index[1] < 0 ? 0 : (int) source[index[1]], index[0] < 0 ? 0 : (int) source[index[0]]
+                    );
+
+                    int32_t packed; std::memcpy(&packed, crtFactor.data() + i, 4);
+                    __m128i factors = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+                    factors = _mm_unpacklo_epi16(factors, factors);
+
+                    __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi32(factors, factors));
+                    __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi32(factors, factors));
+                    lo = _mm_mulhi_epu16(lo, scale), hi = _mm_mulhi_epu16(hi, scale);
+
+                    _mm_storeu_si128((__m128i*) (out + i), _mm_or_si128(_mm_packus_epi16(lo, hi), alpha));
+                }
+#endif
+                for (; i < last; i++) {
+                    if (crtSource[i] < 0) { out[i] = opaque; continue; }
+                    uint32_t pixel = source[crtSource[i]], result = opaque;
+
+                    for (int c = 0; c < 3; c++) {
+                        uint32_t value = (((pixel >> (c * 8)) & 0xFF) * crtFactor[i] * factorScale) >> 16;
+                        result |= std::min<uint32_t>(255, value) << (c * 8);
+                    }
+
+                    out[i] = result;
+                }
+            }
+        }
+
+    public:
+        SoftwarePostProcess(JobPool& pool, int width, int height) : pool(pool), width(width), height(height) {
+            rowSums.resize((size_t) width * height * 4);
+            bloomed.resize((size_t) width * height * 4);
+            BuildCrtTable(3.0f, 1.0f, 1.0f, 1.0f, 1.25f);
+        }
+
+        // Scales the blurred term like the bloom shader's `intensity` uniform.
+        void SetBloomIntensity(float intensity) {
+            blurScale = (uint16_t) std::clamp(std::lround(455.0f * intensity), 0l, 65535l);
+        }
+
+        int Width() const { return width; }
+        int Height() const { return height; }
+
+        // `src` and `dst` are width * height RGBA8 pixels and must not alias.
+        void Process(const uint8_t* src, uint8_t* dst) {
+            pool.ParallelFor(height, rowGrain, [&](size_t begin, size_t end) { HorizontalRows(src, (int) begin, (int) end); });
+            pool.ParallelFor(height, rowGrain, [&](size_t begin, size_t end) { VerticalRows(src, (int) begin, (int) end); });
+            pool.ParallelFor(height, rowGrain, [&](size_t begin, size_t end) { CrtRows(dst, (int) begin, (int) end); });
+        }
+};
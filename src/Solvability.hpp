@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+// Reachability of the player's lateral position across a sequence of obstacle rows. Positions are quantised
+// to quarter units over [-4, 4] and kept as a 33-bit mask, so checking one row is a handful of shifts.
+//
+// Steering moves targetX by speed * timeScale per second while the player moves forward at the same rate, so
+// targetX can shift one unit per unit travelled at any speed. The player then follows targetX through
+// lerp(x, targetX, 0.2 * dt * timeScale), a first-order lag whose length in forward units is speed / 0.2. Over a
+// gap D the reachable lateral offset from rest is D - lag * (1 - e^(-D / lag)), which is what shrinks at speed.
+//
+// Step() treats every row as a point and every row as starting from rest, which is cheap enough for the planner
+// but optimistic. State and Pass() are what the generator validates with: the player has to stay clear of an
+// obstacle for the whole `window` in which their boxes overlap, and the lag x - targetX it carries from one row
+// into the next is tracked per position. Only targetX that moves at full rate from the end of one window, possibly
+// into the next, and then holds on a grid position is considered, so whatever Pass() accepts a real player can clear.
+namespace Solvability {
+    constexpr int positions = 33;
+    constexpr float resolution = 0.25f, rowSpacing = 10.0f, half = 2.0f, window = 2.0f * half;
+    constexpr uint64_t all = (uint64_t(1) << positions) - 1;
+
+    inline float Position(int bit) {
+        return -4.0f + bit * resolution;
+    }
+
+    inline uint64_t Start() {
+        return uint64_t(1) << (positions / 2);
+    }
+
+    // Obstacles and the player are both 2 units wide and raylib treats touching boxes as colliding.
+    inline uint64_t SafeMask(float lane) {
+        uint64_t mask = 0;
+
+        for (int bit = 0; bit < positions; bit++)
+            if (std::fabs(Position(bit) - lane) > half) mask |= uint64_t(1) << bit;
+
+        return mask;
+    }
+
+    inline uint64_t LaneMask(float lane) {
+        static const struct Table {
+            uint64_t masks[8];
+            Table() { for (int i = 0; i < 8; i++) masks[i] = SafeMask((float) i - 3.0f); }
+        } table;
+
+        return table.masks[std::min(7, std::max(0, (int) lane + 3))];
+    }
+
+    // speed grows by 0.0001 * timeScale per second while distance grows by speed * timeScale, so
+    // d(speed) / dz = 0.0001 / speed regardless of timeScale, giving speed^2 = 0.15^2 + 0.0002 * z.
+    inline float SpeedAt(uint64_t obstacle) {
+        return std::sqrt(0.15f * 0.15f + 0.0002f * rowSpacing * (float) (obstacle + 1));
+    }
+
+    inline int ReachSteps(float speed, float distance) {
+        float lag = speed / 0.2f;
+        float reach = distance - lag * (1.0f - std::exp(-distance / lag));
+        return std::min(positions, (int) (std::max(0.0f, reach) / resolution));
+    }
+
+    inline int ReachSteps(float speed) {
+        return ReachSteps(speed, rowSpacing);
+    }
+
+    inline int Bit(float x) {
+        return std::min(positions - 1, std::max(0, (int) std::lround((x + 4.0f) / resolution)));
+    }
+
+    inline uint64_t Dilate(uint64_t mask, int steps) {
+        for (int shift = 1; steps > 0; shift <<= 1) {
+            int amount = std::min(shift, steps);
+            mask |= (mask << amount) | (mask >> amount);
+            steps -= amount;
+        }
+
+        return mask & all;
+    }
+
+    // Positions from which the player can be past an obstacle in `lane`, given where it could be one row before.
+    inline uint64_t Step(uint64_t reachable, float lane, int steps) {
+        return Dilate(reachable, steps) & LaneMask(lane);
+    }
+
+    // Positions targetX can be held at through the last window passed, and for each the lag x - targetX at the
+    // end of that window along the most settled way there found.
+    struct State {
+        uint64_t reachable = 0;
+        float lag[positions] = {};
+    };
+
+    // At rest in the middle of the track, where a run starts.
+    inline State Begin() {
+        State state;
+        state.reachable = Start();
+        return state;
+    }
+
+    // Every position, at rest; for checking sequences on their own.
+    inline State Anywhere() {
+        State state;
+        state.reachable = all;
+        return state;
+    }
+
+    // Everything Pass() needs that depends only on the speed. Obstacles are recycled on the tick after they fall
+    // behind, so rows can sit up to a tick of travel closer than rowSpacing; that tick comes off the gap between
+    // windows. Per move of m steps, tabulates the lag it leaves at the start of the window, how far targetX still
+    // has to go then, and how much of the lag remains after that part of the move and after the rest of the window.
+    struct Crossing {
+        float lag = 0.0f, hold = 0.0f;
+        int moves = 0, steps = 0;
+        float shift[positions] = {}, rest[positions] = {}, moving[positions] = {}, held[positions] = {};
+
+        Crossing() = default;
+
+        explicit Crossing(float speed) : lag(speed / 0.2f), steps(ReachSteps(speed)) {
+            const float gap = std::max(0.0f, rowSpacing - window - speed * 75.0f / 240.0f);
+            const float grow = std::exp(resolution / lag), settle = std::exp(-window / lag);
+            hold = std::exp(-gap / lag), moves = std::min(positions - 1, (int) ((gap + window) / resolution));
+
+            float power = 1.0f;
+            for (int m = 0; m <= moves; m++, power *= grow) {
+                const float inside = std::max(0.0f, m * resolution - gap);
+                shift[m] = inside > 0.0f ? lag * (hold - 1.0f) : lag * hold * (1.0f - power);
+                rest[m] = inside;
+                moving[m] = inside > 0.0f ? 1.0f / (hold * power) : 1.0f, held[m] = settle / moving[m];
+            }
+        }
+    };
+
+    // Takes `state` past an obstacle in `lane` approached at the speed `crossing` was built for, or returns false
+    // and leaves it alone when no way through is left.
+    //
+    // targetX starts moving at full rate when the last window ends and may carry on into this one. With u the
+    // direction and L the lag length, the lag e = x - targetX follows e(t) = (e0 + uL) e^(-t / L) - uL while it
+    // moves and decays towards zero once it is held, so over the window x is only ever extreme at its ends, where
+    // the move stops, or where x turns round, at t = L ln(1 + u e0 / L) and x = targetX(0) + u t.
+    //
+    // targetX is only held where the point model of Step() says the player could be past the lane, which keeps
+    // the scan to positions clear of it and lets Pass() stop at once when the point model finds nothing.
+    inline bool Pass(State& state, float lane, const Crossing& crossing) {
+        const uint64_t candidates = Step(state.reachable, lane, crossing.steps);
+        if (candidates == 0) return false;
+
+        const float lag = crossing.lag;
+        const int moves = crossing.moves;
+
+        // Each position keeps the shortest move that reaches it, which also tends to leave it the least lag, so the
+        // live positions on either side are walked outwards from it and holding still is tried first.
+        State next;
+        for (uint64_t left = candidates; left; left &= left - 1) {
+            const int to = __builtin_ctzll(left);
+            const float settled = Position(to);
+            const uint64_t upTo = (uint64_t(2) << to) - 1;
+            uint64_t below = state.reachable & upTo, above = state.reachable & ~upTo;
+            int found = -1;
+
+            while (below | above) {
+                const int down = below ? 63 - __builtin_clzll(below) : -1, up = above ? __builtin_ctzll(above) : -1;
+                const int from = up < 0 || (down >= 0 && to - down <= up - to) ? down : up, m = std::abs(to - from);
+                if (m > moves || (found >= 0 && m > found)) break;
+                (from == down ? below : above) &= ~(uint64_t(1) << from);
+
+                const float u = (float) ((to > from) - (to < from)), target = settled - u * crossing.rest[m];
+                const float start = state.lag[from] * crossing.hold + u * crossing.shift[m];
+                const float stop = (start + u * lag) * crossing.moving[m] - u * lag, end = stop * crossing.held[m];
+                float low = std::min({ target + start, settled + stop, settled + end });
+                float high = std::max({ target + start, settled + stop, settled + end });
+
+                if (u * start > 0.0f && (1.0f + u * start / lag) * crossing.moving[m] < 1.0f) {
+                    const float turn = target + u * lag * std::log1p(u * start / lag);
+                    low = std::min(low, turn), high = std::max(high, turn);
+                }
+
+                if (high >= lane - half && low <= lane + half) continue;
+                if (found < 0 || std::fabs(end) < std::fabs(next.lag[to])) next.lag[to] = end;
+                found = m;
+            }
+
+            if (found >= 0) next.reachable |= uint64_t(1) << to;
+        }
+
+        if (next.reachable == 0) return false;
+        state = next;
+        return true;
+    }
+
+    // Speeds up to 16 come from a table in bands of 1/32, rounded up to the top of their band, which is the harder
+    // side: a faster player lags further and has less gap to move in.
+    inline bool Pass(State& state, float lane, float speed) {
+        constexpr float band = 1.0f / 32.0f;
+        constexpr int bands = 16 * 32;
+        static const std::vector<Crossing> table = [] {
+            std::vector<Crossing> crossings(bands + 1);
+            for (int i = 1; i <= bands; i++) crossings[i] = Crossing(i * band);
+            return crossings;
+        }();
+
+        const int index = std::max(1, (int) std::ceil(speed / band));
+        return index <= bands ? Pass(state, lane, table[index]) : Pass(state, lane, Crossing(speed));
+    }
+}
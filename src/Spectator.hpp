@@ -0,0 +1,620 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <cstring>
+#include <algorithm>
+
+#include <raylib/raylib.h>
+
+#include "WorldSnapshot.hpp"
+
+#if defined(_WIN32)
+// winsock2.h pulls in windows.h, which clashes with raylib's names, so only the calls used here are declared.
+extern "C" {
+    __declspec(dllimport) int __stdcall WSAStartup(unsigned short version, void* data);
+    __declspec(dllimport) uintptr_t __stdcall socket(int family, int type, int protocol);
+    __declspec(dllimport) int __stdcall bind(uintptr_t socket, const void* address, int length);
+    __declspec(dllimport) int __stdcall getsockname(uintptr_t socket, void* address, int* length);
+    __declspec(dllimport) int __stdcall sendto(uintptr_t socket, const char* data, int length, int flags, const void* address, int addressLength);
+    __declspec(dllimport) int __stdcall recvfrom(uintptr_t socket, char* data, int length, int flags, void* address, int* addressLength);
+    __declspec(dllimport) int __stdcall ioctlsocket(uintptr_t socket, long command, unsigned long* argument);
+    __declspec(dllimport) int __stdcall closesocket(uintptr_t socket);
+    __declspec(dllimport) unsigned short __stdcall htons(unsigned short value);
+    __declspec(dllimport) unsigned long __stdcall htonl(unsigned long value);
+    __declspec(dllimport) unsigned short __stdcall ntohs(unsigned short value);
+    __declspec(dllimport) unsigned long __stdcall ntohl(unsigned long value);
+}
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+// An IPv4 address and port, both in host byte order.
+struct Endpoint {
+    uint32_t address = 0;
+    uint16_t port = 0;
+
+    static constexpr uint32_t loopback = 0x7F000001;
+
+    bool operator==(const Endpoint& other) const {
+        return address == other.address && port == other.port;
+    }
+
+    // Accepts "a.b.c.d", "localhost" or "any", the last meaning every interface.
+    static bool ParseAddress(const std::string& host, uint32_t& out) {
+        unsigned a, b, c, d;
+        char rest;
+
+        if (host == "localhost") { out = loopback; return true; }
+        if (host == "any") { out = 0; return true; }
+        if (std::sscanf(host.c_str(), "%u.%u.%u.%u%c", &a, &b, &c, &d, &rest) != 4 || a > 255 || b > 255 || c > 255 || d > 255) return false;
+        out = a << 24 | b << 16 | c << 8 | d;
+        return true;
+    }
+
+    // Accepts "a.b.c.d:port", "localhost:port" or a bare port on localhost.
+    static bool Parse(const std::string& text, Endpoint& out) {
+        const size_t colon = text.rfind(':');
+        const std::string host = colon == std::string::npos ? "localhost" : text.substr(0, colon);
+        const std::string port = colon == std::string::npos ? text : text.substr(colon + 1);
+        unsigned p;
+        char rest;
+
+        if (std::sscanf(port.c_str(), "%u%c", &p, &rest) != 1 || p == 0 || p > 65535) return false;
+        out.port = (uint16_t) p;
+        return ParseAddress(host, out.address);
+    }
+};
+
+// A non-blocking UDP socket. Sends that would block are dropped and receives return straight away when nothing
+// has arrived, so neither ever holds up the caller.
+class UdpSocket {
+    private:
+#if defined(_WIN32)
+        struct Address {
+            uint16_t family, port;
+            uint32_t address;
+            uint8_t zero[8];
+        };
+
+        using Generic = void;
+
+        uintptr_t handle = ~uintptr_t(0);
+
+        bool Valid() const { return handle != ~uintptr_t(0); }
+#else
+        using Address = sockaddr_in;
+        using Generic = sockaddr;
+
+        int handle = -1;
+
+        bool Valid() const { return handle >= 0; }
+#endif
+
+        static Address ToAddress(const Endpoint& endpoint) {
+            Address address;
+            std::memset(&address, 0, sizeof(address));
+#if defined(_WIN32)
+            address.family = 2, address.port = htons(endpoint.port), address.address = htonl(endpoint.address);
+#else
+            address.sin_family = AF_INET, address.sin_port = htons(endpoint.port), address.sin_addr.s_addr = htonl(endpoint.address);
+#endif
+            return address;
+        }
+
+        static Endpoint ToEndpoint(const Address& address) {
+#if defined(_WIN32)
+            return { (uint32_t) ntohl(address.address), ntohs(address.port) };
+#else
+            return { ntohl(address.sin_addr.s_addr), ntohs(address.sin_port) };
+#endif
+        }
+
+    public:
+        ~UdpSocket() {
+            Close();
+        }
+
+        // Binds to `local`; a zero port picks a free one.
+        bool Open(const Endpoint& local) {
+            Close();
+#if defined(_WIN32)
+            static bool started = false;
+            uint8_t data[512];
+            if (!started) started = WSAStartup(0x0202, data) == 0;
+
+            handle = socket(2, 2, 17);
+            unsigned long nonBlocking = 1;
+            if (!Valid() || ioctlsocket(handle, (long) 0x8004667Eul, &nonBlocking) != 0) { Close(); return false; }
+#else
+            handle = socket(AF_INET, SOCK_DGRAM, 0);
+            if (!Valid() || fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) != 0) { Close(); return false; }
+#endif
+            const Address address = ToAddress(local);
+            if (bind(handle, (const Generic*) &address, sizeof(address)) != 0) { Close(); return false; }
+            return true;
+        }
+
+        void Close() {
+            if (!Valid()) return;
+#if defined(_WIN32)
+            closesocket(handle);
+            handle = ~uintptr_t(0);
+#else
+            close(handle);
+            handle = -1;
+#endif
+        }
+
+        uint16_t Port() const {
+            Address address;
+#if defined(_WIN32)
+            int length = sizeof(address);
+#else
+            socklen_t length = sizeof(address);
+#endif
+            if (!Valid() || getsockname(handle, (Generic*) &address, &length) != 0) return 0;
+            return ToEndpoint(address).port;
+        }
+
+        bool Send(const Endpoint& to, const void* data, size_t bytes) {
+            if (!Valid()) return false;
+            const Address address = ToAddress(to);
+            return sendto(handle, (const char*) data, (int) bytes, 0, (const Generic*) &address, sizeof(address)) == (int) bytes;
+        }
+
+        // Bytes in the next datagram, or -1 when none is waiting.
+        int Receive(void* data, size_t bytes, Endpoint& from) {
+            if (!Valid()) return -1;
+            Address address;
+#if defined(_WIN32)
+            int length = sizeof(address);
+#else
+            socklen_t length = sizeof(address);
+#endif
+            const int received = (int) recvfrom(handle, (char*) data, (int) bytes, 0, (Generic*) &address, &length);
+            if (received >= 0) from = ToEndpoint(address);
+            return received;
+        }
+};
+
+// What a spectator needs from a WorldSnapshot, flattened into 32-bit words: the scalar state, then seven words
+// per obstacle. Flattening makes the delta a plain word compare, and the words travel bit for bit.
+struct SpectatorFrame {
+    enum Word {
+        PositionX, PositionY, PositionZ, CameraX, CameraY, CameraZ, TargetX, TargetY, TargetZ, UpX, UpY, UpZ, Fovy, Projection,
+        Score, ScoreHigh, Origin, OriginHigh, Speed, Rewindable, Hue, MaxObstacles, Runs, Flags, SizeX, SizeY, SizeZ, PlayerColor,
+        Words
+    };
+
+    static constexpr int obstacleWords = 7, obstacleZ = 2;
+
+    uint32_t words[Words] = {};
+    std::vector<uint32_t> obstacles;
+
+    static uint32_t Bits(float value) { uint32_t bits; std::memcpy(&bits, &value, sizeof(bits)); return bits; }
+    static float Float(uint32_t bits) { float value; std::memcpy(&value, &bits, sizeof(value)); return value; }
+    static uint32_t Bits(Color color) { uint32_t bits; std::memcpy(&bits, &color, sizeof(bits)); return bits; }
+    static Color ColorOf(uint32_t bits) { Color color; std::memcpy(&color, &bits, sizeof(color)); return color; }
+
+    static void Put(uint32_t* out, const Vector3& value) {
+        out[0] = Bits(value.x), out[1] = Bits(value.y), out[2] = Bits(value.z);
+    }
+
+    static Vector3 Vector(const uint32_t* in) {
+        return { Float(in[0]), Float(in[1]), Float(in[2]) };
+    }
+
+    static void Put(uint32_t* out, double value) {
+        std::memcpy(out, &value, sizeof(value));
+    }
+
+    static double Double(const uint32_t* in) {
+        double value;
+        std::memcpy(&value, in, sizeof(value));
+        return value;
+    }
+
+    size_t Count() const {
+        return obstacles.size() / obstacleWords;
+    }
+
+    double OriginValue() const {
+        return Double(&words[Origin]);
+    }
+
+    Vector3 Position() const {
+        return Vector(&words[PositionX]);
+    }
+
+    Camera3D Camera() const {
+        return { Vector(&words[CameraX]), Vector(&words[TargetX]), Vector(&words[UpX]), Float(words[Fovy]), (int) words[Projection] };
+    }
+
+    // Keeps the obstacle storage for reuse.
+    void Clear() {
+        std::memset(words, 0, sizeof(words));
+        obstacles.clear();
+    }
+
+    // Obstacles only move when recycled or when the world is rebased. A rebase moves all of them by the change in
+    // origin, which both ends apply the same way, so it costs nothing on the wire.
+    void Shift(double from, double to) {
+        if (from == to) return;
+        const float shift = (float) (to - from);
+        for (size_t i = obstacleZ; i < obstacles.size(); i += obstacleWords) obstacles[i] = Bits(Float(obstacles[i]) + shift);
+    }
+
+    void From(const WorldSnapshot& view) {
+        Put(&words[PositionX], view.position);
+        Put(&words[CameraX], view.camera.position), Put(&words[TargetX], view.camera.target), Put(&words[UpX], view.camera.up);
+        words[Fovy] = Bits(view.camera.fovy), words[Projection] = (uint32_t) view.camera.projection;
+        Put(&words[Score], view.score), Put(&words[Origin], view.origin);
+        words[Speed] = Bits(view.speed), words[Rewindable] = Bits(view.rewindable);
+        words[Hue] = (uint32_t) view.hue, words[MaxObstacles] = (uint32_t) view.maxObstacles, words[Runs] = (uint32_t) view.runs;
+        words[Flags] = (uint32_t) view.started | (uint32_t) view.dead << 1 | (uint32_t) view.paused << 2 | (uint32_t) view.demo << 3;
+        Put(&words[SizeX], view.size), words[PlayerColor] = Bits(view.color);
+
+        obstacles.resize(view.obstacles.size() * obstacleWords);
+        uint32_t* out = obstacles.data();
+
+        for (const ObstacleState& obstacle : view.obstacles) {
+            Put(out, obstacle.position), Put(out + 3, obstacle.size), out[6] = Bits(obstacle.color);
+            out += obstacleWords;
+        }
+    }
+
+    // Fills in everything but the sequence numbers, the blend towards the previous tick and the tick clock.
+    void To(WorldSnapshot& view) const {
+        view.position = Position(), view.camera = Camera();
+        view.score = Double(&words[Score]), view.origin = Double(&words[Origin]);
+        view.speed = Float(words[Speed]), view.rewindable = Float(words[Rewindable]);
+        view.hue = (int) words[Hue], view.maxObstacles = (int) words[MaxObstacles], view.runs = (int) words[Runs];
+        view.started = words[Flags] & 1, view.dead = words[Flags] & 2, view.paused = words[Flags] & 4, view.demo = words[Flags] & 8;
+        view.size = Vector(&words[SizeX]), view.color = ColorOf(words[PlayerColor]);
+
+        view.obstacles.resize(Count());
+        const uint32_t* in = obstacles.data();
+
+        for (ObstacleState& obstacle : view.obstacles) {
+            obstacle = { Vector(in), Vector(in + 3), ColorOf(in[6]) };
+            in += obstacleWords;
+        }
+    }
+
+    bool operator==(const SpectatorFrame& other) const {
+        return std::memcmp(words, other.words, sizeof(words)) == 0 && obstacles == other.obstacles;
+    }
+};
+
+// Wire format, little-endian. A state packet is a header, a mask of the scalar words that changed followed by
+// those words, then the obstacle count, the number of changed obstacles and, for each, its index, a mask of its
+// changed words and those words. A delta is taken against the packet numbered `baseline`; a keyframe has a
+// baseline of zero and is taken against an empty frame. Spectators answer with an ack packet: the magic and the
+// newest sequence they have applied, zero to join.
+struct SpectatorHeader {
+    uint32_t magic, sequence, baseline;
+};
+
+class SpectatorCodec {
+    public:
+        static constexpr uint32_t stateMagic = 0x50535243, ackMagic = 0x4B535243, challengeMagic = 0x48535243;
+
+        // Packets either end remembers, and so how far back a baseline can reach.
+        static constexpr uint32_t history = 32;
+
+    private:
+        template <typename T>
+        static void Put(std::vector<uint8_t>& out, T value) {
+            const uint8_t* bytes = (const uint8_t*) &value;
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        }
+
+        template <typename T>
+        static bool Take(const uint8_t*& in, const uint8_t* end, T& value) {
+            if ((size_t) (end - in) < sizeof(T)) return false;
+            std::memcpy(&value, in, sizeof(T)), in += sizeof(T);
+            return true;
+        }
+
+    public:
+        // Appends `frame` as a delta against `base`. `base` is brought forward to match the new frame exactly as
+        // Decode() brings the spectator's copy forward, so the two ends stay bit for bit equal.
+        static void Encode(SpectatorFrame& base, const SpectatorFrame& frame, std::vector<uint8_t>& out) {
+            uint32_t mask = 0;
+            for (int i = 0; i < SpectatorFrame::Words; i++) if (frame.words[i] != base.words[i]) mask |= 1u << i;
+
+            Put(out, mask);
+            for (int i = 0; i < SpectatorFrame::Words; i++) if (mask >> i & 1) Put(out, frame.words[i]);
+
+            base.Shift(base.OriginValue(), frame.OriginValue());
+            std::memcpy(base.words, frame.words, sizeof(base.words));
+            base.obstacles.resize(frame.obstacles.size());
+
+            const size_t countAt = out.size();
+            uint16_t changed = 0;
+            Put(out, (uint16_t) frame.Count()), Put(out, changed);
+
+            for (size_t i = 0; i < frame.Count(); i++) {
+                const uint32_t* now = &frame.obstacles[i * SpectatorFrame::obstacleWords];
+                uint32_t* was = &base.obstacles[i * SpectatorFrame::obstacleWords];
+                uint8_t obstacleMask = 0;
+
+                for (int w = 0; w < SpectatorFrame::obstacleWords; w++) if (now[w] != was[w]) obstacleMask |= 1 << w;
+                if (!obstacleMask) continue;
+
+                Put(out, (uint16_t) i), Put(out, obstacleMask), changed++;
+                for (int w = 0; w < SpectatorFrame::obstacleWords; w++) if (obstacleMask >> w & 1) Put(out, now[w]), was[w] = now[w];
+            }
+
+            std::memcpy(out.data() + countAt + sizeof(uint16_t), &changed, sizeof(changed));
+        }
+
+        // Applies the body of a state packet to `frame`, which must hold its baseline. Returns false on a
+        // malformed packet, leaving `frame` in an unusable state.
+        static bool Decode(SpectatorFrame& frame, const uint8_t* in, const uint8_t* end) {
+            uint32_t mask = 0;
+            if (!Take(in, end, mask)) return false;
+
+            const double from = frame.OriginValue();
+            for (int i = 0; i < SpectatorFrame::Words; i++) if ((mask >> i & 1) && !Take(in, end, frame.words[i])) return false;
+            frame.Shift(from, frame.OriginValue());
+
+            uint16_t count = 0, changed = 0;
+            if (!Take(in, end, count) || !Take(in, end, changed)) return false;
+            frame.obstacles.resize((size_t) count * SpectatorFrame::obstacleWords);
+
+            for (uint16_t c = 0; c < changed; c++) {
+                uint16_t index = 0;
+                uint8_t obstacleMask = 0;
+                if (!Take(in, end, index) || !Take(in, end, obstacleMask) || index >= count) return false;
+
+                uint32_t* was = &frame.obstacles[(size_t) index * SpectatorFrame::obstacleWords];
+                for (int w = 0; w < SpectatorFrame::obstacleWords; w++) if ((obstacleMask >> w & 1) && !Take(in, end, was[w])) return false;
+            }
+
+            return in == end;
+        }
+};
+
+// Sends the game's state to whoever has joined, at `rate` packets a second. Each spectator's packet is a delta
+// against the newest packet it has acked, so a lost packet only makes the next few deltas a little larger. A
+// spectator gets a keyframe when it joins or when its last ack is older than the history. Spectators that have
+// not been heard from for `timeout` seconds are dropped.
+//
+// Acks carry a cookie derived from the sender's address and a per-session secret. An ack without the right cookie
+// only gets the cookie back, in a packet no larger than the ack, so nobody can subscribe an address whose replies
+// they cannot see, and the server never sends more to an unverified address than it was sent.
+class SpectatorServer {
+    public:
+        static constexpr uint16_t defaultPort = 47800;
+        static constexpr size_t maxSpectators = 8;
+
+    private:
+        struct Spectator {
+            Endpoint endpoint;
+            double heard = 0.0;
+            uint32_t acked = 0;
+        };
+
+        UdpSocket socket;
+        std::vector<Spectator> spectators;
+        SpectatorFrame frames[SpectatorCodec::history], base;
+        uint32_t sequences[SpectatorCodec::history] = {};
+        std::vector<uint8_t> packet;
+        const double interval, timeout;
+        const uint64_t secret;
+        double nextSend = 0.0;
+        uint32_t sequence = 0;
+        uint64_t bytes = 0, packets = 0, keyframes = 0, challenges = 0;
+
+        static uint64_t Secret() {
+            std::random_device device;
+            return (uint64_t) device() << 32 ^ device() ^ (uint64_t) std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+
+        uint32_t Cookie(const Endpoint& endpoint) const {
+            uint64_t x = secret ^ ((uint64_t) endpoint.address << 16 | endpoint.port);
+            x ^= x >> 30, x *= 0xBF58476D1CE4E5B9ull, x ^= x >> 27, x *= 0x94D049BB133111EBull, x ^= x >> 31;
+            return (uint32_t) x | 1;
+        }
+
+        void Listen(double now) {
+            uint32_t ack[3];
+            Endpoint from;
+
+            for (int size; (size = socket.Receive(ack, sizeof(ack), from)) >= 0;) {
+                if (size != (int) sizeof(ack) || ack[0] != SpectatorCodec::ackMagic || ack[1] > sequence) continue;
+
+                const uint32_t cookie = Cookie(from);
+                if (ack[2] != cookie) {
+                    const uint32_t challenge[2] = { SpectatorCodec::challengeMagic, cookie };
+                    socket.Send(from, challenge, sizeof(challenge)), challenges++;
+                    continue;
+                }
+
+                auto known = std::find_if(spectators.begin(), spectators.end(), [&](const Spectator& spectator) { return spectator.endpoint == from; });
+
+                if (known != spectators.end()) known->heard = now, known->acked = std::max(known->acked, ack[1]);
+                else if (spectators.size() < maxSpectators) spectators.push_back({ from, now, 0 });
+            }
+
+            spectators.erase(std::remove_if(spectators.begin(), spectators.end(), [&](const Spectator& spectator) { return now - spectator.heard > timeout; }), spectators.end());
+        }
+
+    public:
+        SpectatorServer(double rate = 30.0, double timeout = 5.0) : interval(1.0 / rate), timeout(timeout), secret(Secret()) {
+            packet.reserve(1500);
+            spectators.reserve(maxSpectators);
+        }
+
+        // Without an address it only listens on loopback; zero opens it to every interface.
+        bool Open(uint16_t port, uint32_t address = Endpoint::loopback) {
+            return socket.Open({ address, port });
+        }
+
+        uint16_t Port() const {
+            return socket.Port();
+        }
+
+        // Once per rendered frame with the snapshot being drawn and the current time in seconds.
+        void Frame(const WorldSnapshot& view, double now) {
+            Listen(now);
+            if (now < nextSend) return;
+            nextSend = nextSend + interval < now ? now + interval : nextSend + interval;
+            if (spectators.empty()) return;
+
+            const uint32_t slot = ++sequence % SpectatorCodec::history;
+            frames[slot].From(view), sequences[slot] = sequence;
+
+            for (const Spectator& spectator : spectators) {
+                const uint32_t baseline = spectator.acked;
+                const bool delta = baseline != 0 && sequence - baseline < SpectatorCodec::history && sequences[baseline % SpectatorCodec::history] == baseline;
+
+                if (delta) base = frames[baseline % SpectatorCodec::history];
+                else base.Clear(), keyframes++;
+
+                packet.clear();
+                const SpectatorHeader header = { SpectatorCodec::stateMagic, sequence, delta ? baseline : 0 };
+                packet.insert(packet.end(), (const uint8_t*) &header, (const uint8_t*) &header + sizeof(header));
+                SpectatorCodec::Encode(base, frames[slot], packet);
+
+                if (socket.Send(spectator.endpoint, packet.data(), packet.size())) bytes += packet.size(), packets++;
+            }
+        }
+
+        uint32_t Sequence() const { return sequence; }
+        size_t Spectators() const { return spectators.size(); }
+        uint64_t Bytes() const { return bytes; }
+        uint64_t Packets() const { return packets; }
+        uint64_t Keyframes() const { return keyframes; }
+        uint64_t Challenges() const { return challenges; }
+};
+
+// Rebuilds the game's state from a SpectatorServer's packets, keeping the last few states as possible baselines.
+// Between packets the view is blended from the state before the newest packet to the newest, over the measured
+// packet interval, the way the game blends between ticks.
+class SpectatorClient {
+    private:
+        UdpSocket socket;
+        Endpoint server;
+        SpectatorFrame frames[SpectatorCodec::history], scratch;
+        uint32_t sequences[SpectatorCodec::history] = {};
+        std::vector<uint8_t> buffer;
+        uint32_t applied = 0, lossPercent = 0, cookie = 0;
+        double lastAck = -1e9, receivedAt = 0.0, interval = 1.0 / 30.0;
+        Vector3 previousPosition = {};
+        Camera3D previousCamera = {};
+        uint64_t received = 0, skipped = 0, bytes = 0;
+
+        // Deterministic stand-in for a lossy network, for the loopback check.
+        bool Lost(uint32_t sequence) const {
+            uint64_t x = (uint64_t) sequence * 0x9E3779B97F4A7C15ull;
+            x ^= x >> 29, x *= 0xBF58476D1CE4E5B9ull, x ^= x >> 32;
+            return x % 100 < lossPercent;
+        }
+
+        bool Apply(const uint8_t* data, size_t size, double now) {
+            SpectatorHeader header;
+            if (size < sizeof(header)) return false;
+            std::memcpy(&header, data, sizeof(header));
+            if (header.magic != SpectatorCodec::stateMagic || header.sequence <= applied || Lost(header.sequence)) return false;
+
+            const uint32_t baseline = header.baseline;
+            if (baseline != 0 && sequences[baseline % SpectatorCodec::history] != baseline) {
+                skipped++;
+                return false;
+            }
+
+            if (baseline == 0) scratch.Clear();
+            else scratch = frames[baseline % SpectatorCodec::history];
+
+            if (!SpectatorCodec::Decode(scratch, data + sizeof(header), data + size)) return false;
+
+            // The blend starts from the state being replaced, moved along with any rebase. A new run or the first
+            // packet starts without one.
+            const SpectatorFrame& current = frames[applied % SpectatorCodec::history];
+            const bool continuous = applied != 0 && scratch.words[SpectatorFrame::Runs] == current.words[SpectatorFrame::Runs];
+            const SpectatorFrame& before = continuous ? current : scratch;
+            const float shift = (float) (scratch.OriginValue() - before.OriginValue());
+            previousPosition = before.Position(), previousCamera = before.Camera();
+            previousPosition.z += shift, previousCamera.position.z += shift, previousCamera.target.z += shift;
+
+            if (applied != 0) interval = interval + (std::clamp(now - receivedAt, 1.0 / 240.0, 0.25) - interval) * 0.1;
+
+            const uint32_t slot = header.sequence % SpectatorCodec::history;
+            std::swap(frames[slot], scratch);
+            sequences[slot] = applied = header.sequence, receivedAt = now;
+            return true;
+        }
+
+        void Ack(double now) {
+            const uint32_t ack[3] = { SpectatorCodec::ackMagic, applied, cookie };
+            socket.Send(server, ack, sizeof(ack));
+            lastAck = now;
+        }
+
+    public:
+        SpectatorClient() {
+            buffer.resize(65536);
+        }
+
+        bool Open(const Endpoint& to) {
+            server = to;
+            return socket.Open({ 0, 0 });
+        }
+
+        void SetLoss(uint32_t percent) {
+            lossPercent = percent;
+        }
+
+        // Applies every packet that has arrived and acks the newest, or keeps the spectator known to the server
+        // once a second when nothing arrives. A challenge is answered straight away with its cookie. Returns true
+        // if the state changed.
+        bool Poll(double now) {
+            bool changed = false;
+            Endpoint from;
+
+            bool challenged = false;
+
+            for (int size; (size = socket.Receive(buffer.data(), buffer.size(), from)) >= 0;) {
+                if (!(from == server)) continue;
+                bytes += size;
+
+                uint32_t challenge[2];
+                if (size == (int) sizeof(challenge)) {
+                    std::memcpy(challenge, buffer.data(), sizeof(challenge));
+                    if (challenge[0] == SpectatorCodec::challengeMagic) { cookie = challenge[1], challenged = true; continue; }
+                }
+
+                received++;
+                changed |= Apply(buffer.data(), (size_t) size, now);
+            }
+
+            if (changed || challenged || now - lastAck >= 1.0) Ack(now);
+            return changed;
+        }
+
+        // Fills in everything the renderer reads, blended for `now`.
+        void Fill(WorldSnapshot& view, double now) const {
+            State().To(view);
+            view.previousPosition = previousPosition, view.previousCamera = previousCamera;
+            view.alpha = (float) std::clamp((now - receivedAt) / interval, 0.0, 1.0);
+        }
+
+        bool Synced() const { return applied != 0; }
+        uint32_t Applied() const { return applied; }
+        const SpectatorFrame& State() const { return frames[applied % SpectatorCodec::history]; }
+        uint64_t Received() const { return received; }
+        uint64_t Skipped() const { return skipped; }
+        uint64_t Bytes() const { return bytes; }
+};
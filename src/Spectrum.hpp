@@ -0,0 +1,284 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <raylib/raylib.h>
+
+#include "TripleBuffer.hpp"
+
+// In-place radix-2 FFT of `size` complex values kept as separate real and imaginary arrays, which lets four
+// butterflies share each SSE load. The twiddles of every stage sit back to back, the stage with half-width h
+// at [h, 2h), so a stage reads its own in order.
+class Fft {
+    private:
+        const int size;
+        std::vector<float> twiddleRe, twiddleIm;
+        std::vector<uint32_t> reversed;
+
+    public:
+        explicit Fft(int size) : size(size), twiddleRe(size), twiddleIm(size), reversed(size) {
+            int bits = 0;
+            while ((1 << bits) < size) bits++;
+
+            for (int half = 1; half < size; half *= 2) {
+                for (int j = 0; j < half; j++) {
+                    const double angle = -3.14159265358979323846 * j / half;
+                    twiddleRe[half + j] = (float) std::cos(angle), twiddleIm[half + j] = (float) std::sin(angle);
+                }
+            }
+
+            for (int i = 0; i < size; i++) {
+                uint32_t reverse = 0;
+                for (int b = 0; b < bits; b++) reverse |= ((i >> b) & 1u) << (bits - 1 - b);
+                reversed[i] = reverse;
+            }
+        }
+
+        int Size() const {
+            return size;
+        }
+
+        // Where input sample `i` has to be placed before Transform().
+        uint32_t Reversed(int i) const {
+            return reversed[i];
+        }
+
+        // Expects the input in bit-reversed order and leaves the spectrum in natural order. Both paths do the
+        // same operations in the same order, so their results match bit for bit.
+        void Transform(float* re, float* im, bool vectorised = true) const {
+            for (int half = 1; half < size; half *= 2) {
+                const float* wr = twiddleRe.data() + half;
+                const float* wi = twiddleIm.data() + half;
+
+                for (int start = 0; start < size; start += 2 * half) {
+                    float* ar = re + start, *ai = im + start, *br = ar + half, *bi = ai + half;
+                    int j = 0;
+#if defined(__SSE2__)
+                    if (vectorised) {
+                        for (; j + 4 <= half; j += 4) {
+                            const __m128 cr = _mm_loadu_ps(wr + j), ci = _mm_loadu_ps(wi + j);
+                            const __m128 xr = _mm_loadu_ps(br + j), xi = _mm_loadu_ps(bi + j);
+                            const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, cr), _mm_mul_ps(xi, ci));
+                            const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, ci), _mm_mul_ps(xi, cr));
+                            const __m128 yr = _mm_loadu_ps(ar + j), yi = _mm_loadu_ps(ai + j);
+
+                            _mm_storeu_ps(ar + j, _mm_add_ps(yr, tr)), _mm_storeu_ps(ai + j, _mm_add_ps(yi, ti));
+                            _mm_storeu_ps(br + j, _mm_sub_ps(yr, tr)), _mm_storeu_ps(bi + j, _mm_sub_ps(yi, ti));
+                        }
+                    }
+#endif
+                    for (; j < half; j++) {
+                        const float tr = br[j] * wr[j] - bi[j] * wi[j], ti = br[j] * wi[j] + bi[j] * wr[j];
+                        br[j] = ar[j] - tr, bi[j] = ai[j] - ti;
+                        ar[j] = ar[j] + tr, ai[j] = ai[j] + ti;
+                    }
+                }
+            }
+        }
+};
+
+// Levels of the music that is playing, each from zero to one. `pulse` jumps to one on every onset in the low end
+// and fades out over a fraction of a second; `onsets` counts them, so a reader can tell a new one from the last.
+struct AudioBands {
+    float bass = 0.0f, mid = 0.0f, treble = 0.0f, pulse = 0.0f;
+    uint32_t onsets = 0;
+};
+
+// Spectrum analysis that follows the playback of a sound. raylib mixes Sounds on its own audio thread and offers
+// no hook into it, so the analysis runs on a thread of its own over a copy of the samples, clocked by Play(),
+// Pause() and Resume(), and never touches the audio device or its locks. Every hop it transforms a Hann window
+// ending at the playback position and publishes the band levels through a triple buffer, so reading them costs
+// the renderer one atomic exchange and a copy of a few floats.
+class Spectrum {
+    public:
+        static constexpr int size = 2048, hop = 512, bands = 3;
+
+    private:
+        const std::vector<float> samples;
+        const int sampleRate;
+        Fft fft;
+        std::vector<float> window, re, im;
+        int edges[bands + 1];
+        bool vectorised = true;
+
+        TripleBuffer<AudioBands> published;
+        AudioBands front;
+
+        // Playing: the steady clock, in nanoseconds, at which playback started. Paused: minus one minus the position.
+        std::atomic<int64_t> clock { std::numeric_limits<int64_t>::min() };
+        std::atomic<bool> running { false };
+        std::thread worker;
+
+        // Analysis state, only touched by whoever calls Analyse().
+        AudioBands state;
+        float peak[bands], lastBass = -120.0f, rise = 0.0f;
+        int sinceOnset = 1 << 20;
+
+        static int64_t Now() {
+            return (int64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static std::vector<float> Mono(Wave wave) {
+            std::vector<float> mono;
+            float* interleaved = wave.data ? LoadWaveSamples(wave) : nullptr;
+            if (!interleaved) return mono;
+
+            const int channels = std::max(1u, wave.channels);
+            mono.resize(wave.frameCount);
+            for (size_t i = 0; i < mono.size(); i++) {
+                float sum = 0.0f;
+                for (int c = 0; c < channels; c++) sum += interleaved[i * channels + c];
+                mono[i] = sum / channels;
+            }
+
+            UnloadWaveSamples(interleaved);
+            return mono;
+        }
+
+        // Sample the window ends at, or -1 while paused or stopped.
+        int64_t Position() const {
+            const int64_t now = clock.load(std::memory_order_acquire);
+            if (now < 0) return -1;
+            return (Now() - now) * sampleRate / 1000000000;
+        }
+
+        void Work() {
+            const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>((double) hop / sampleRate));
+            auto next = std::chrono::steady_clock::now();
+
+            while (running.load(std::memory_order_acquire)) {
+                published.Back() = Analyse(Position());
+                published.Publish();
+
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+        }
+
+    public:
+        Spectrum(std::vector<float> samples, int sampleRate)
+            : samples(std::move(samples)), sampleRate(std::max(1, sampleRate)), fft(size), window(size), re(size), im(size) {
+            for (int i = 0; i < size; i++) window[i] = 0.5f - 0.5f * (float) std::cos(2.0 * 3.14159265358979323846 * i / (size - 1));
+
+            // Bass up to 150 Hz, mids up to 2 kHz, treble up to 10 kHz, skipping the DC bin.
+            const double cutoffs[bands + 1] = { 30.0, 150.0, 2000.0, 10000.0 };
+            for (int b = 0; b <= bands; b++) edges[b] = std::clamp((int) std::lround(cutoffs[b] * size / this->sampleRate), 1, size / 2);
+            for (float& value : peak) value = -50.0f;
+        }
+
+        explicit Spectrum(Wave wave) : Spectrum(Mono(wave), (int) wave.sampleRate) {}
+
+        ~Spectrum() {
+            Stop();
+        }
+
+        bool Empty() const {
+            return samples.empty();
+        }
+
+        size_t Bytes() const {
+            return (samples.capacity() + window.capacity() + re.capacity() + im.capacity()) * sizeof(float) + size * (2 * sizeof(float) + sizeof(uint32_t));
+        }
+
+        // Only for comparing against the scalar path; set it before Start().
+        void SetVectorised(bool enabled) {
+            vectorised = enabled;
+        }
+
+        void Start() {
+            if (running.exchange(true)) return;
+            worker = std::thread(&Spectrum::Work, this);
+        }
+
+        void Stop() {
+            if (!running.exchange(false)) return;
+            worker.join();
+        }
+
+        // Render thread, next to the matching calls on the Sound.
+        void Play() {
+            clock.store(Now(), std::memory_order_release);
+        }
+
+        void Pause() {
+            const int64_t started = clock.load(std::memory_order_relaxed);
+            if (started >= 0) clock.store(-(Now() - started) - 1, std::memory_order_release);
+        }
+
+        void Resume() {
+            const int64_t paused = clock.load(std::memory_order_relaxed);
+            if (paused < 0 && paused != std::numeric_limits<int64_t>::min()) clock.store(Now() - (-paused - 1), std::memory_order_release);
+        }
+
+        // Render thread, once per frame: the newest levels the analysis thread has published.
+        const AudioBands& Bands() {
+            if (published.Update()) front = published.Front();
+            return front;
+        }
+
+        // One hop of analysis for the window ending at sample `end`; samples outside the clip count as silence.
+        // Band levels are in decibels against a full-scale sine, scaled into the 40 dB below a peak that follows
+        // loud passages at once and falls 6 dB a second in quiet ones. An onset is a jump in the bass well above
+        // the recent average rise, at most one every 120 ms.
+        const AudioBands& Analyse(int64_t end) {
+            for (int i = 0; i < size; i++) {
+                const int64_t index = end - size + i;
+                re[fft.Reversed(i)] = end >= 0 && index >= 0 && index < (int64_t) samples.size() ? samples[(size_t) index] * window[i] : 0.0f;
+                im[i] = 0.0f;
+            }
+
+            fft.Transform(re.data(), im.data(), vectorised);
+
+            const float hopSeconds = (float) hop / sampleRate, reference = (size / 4.0f) * (size / 4.0f);
+            float levels[bands];
+
+            for (int b = 0; b < bands; b++) {
+                float energy = 0.0f;
+                int k = edges[b];
+#if defined(__SSE2__)
+                if (vectorised) {
+                    __m128 sum = _mm_setzero_ps();
+                    for (; k + 4 <= edges[b + 1]; k += 4) {
+                        const __m128 r = _mm_loadu_ps(&re[k]), i = _mm_loadu_ps(&im[k]);
+                        sum = _mm_add_ps(sum, _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(i, i)));
+                    }
+
+                    float lanes[4];
+                    _mm_storeu_ps(lanes, sum);
+                    energy = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+                }
+#endif
+                for (; k < edges[b + 1]; k++) energy += re[k] * re[k] + im[k] * im[k];
+
+                const float decibels = 10.0f * std::log10(energy / reference + 1e-12f);
+                peak[b] = std::max({ decibels, peak[b] - 6.0f * hopSeconds, -50.0f });
+                levels[b] = std::clamp((decibels - (peak[b] - 40.0f)) / 40.0f, 0.0f, 1.0f);
+
+                if (b == 0) {
+                    const float jump = std::max(0.0f, decibels - lastBass);
+                    lastBass = decibels, sinceOnset++;
+
+                    if (jump > std::max(6.0f, rise * 3.0f) && levels[0] > 0.5f && sinceOnset * hopSeconds >= 0.12f)
+                        state.onsets++, state.pulse = 1.0f, sinceOnset = 0;
+                    rise += (jump - rise) * 0.05f;
+                }
+            }
+
+            // Levels rise within a hop and fall over about a tenth of a second.
+            float* smoothed[bands] = { &state.bass, &state.mid, &state.treble };
+            for (int b = 0; b < bands; b++) *smoothed[b] += (levels[b] - *smoothed[b]) * (levels[b] > *smoothed[b] ? 0.8f : 0.25f);
+            state.pulse *= std::exp(-hopSeconds / 0.15f);
+            return state;
+        }
+};
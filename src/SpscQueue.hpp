@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+template <typename T>
+class SpscQueue {
+    private:
+        std::vector<T> slots;
+        const size_t mask;
+        alignas(64) std::atomic<size_t> head { 0 };
+        alignas(64) std::atomic<size_t> tail { 0 };
+
+    public:
+        // `capacity` is rounded up to a power of two.
+        explicit SpscQueue(size_t capacity) : slots(RoundUp(capacity)), mask(RoundUp(capacity) - 1) {}
+
+        static size_t RoundUp(size_t value) {
+            size_t size = 1;
+            while (size < value) size <<= 1;
+            return size;
+        }
+
+        bool TryPush(const T& value) {
+            size_t back = tail.load(std::memory_order_relaxed);
+            if (back - head.load(std::memory_order_acquire) > mask) return false;
+            slots[back & mask] = value;
+            tail.store(back + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPop(T& value) {
+            size_t front = head.load(std::memory_order_relaxed);
+            if (front == tail.load(std::memory_order_acquire)) return false;
+            value = slots[front & mask];
+            head.store(front + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side: the front element stays valid until it is popped or dropped.
+        const T* Front() const {
+            size_t front = head.load(std::memory_order_relaxed);
+            if (front == tail.load(std::memory_order_acquire)) return nullptr;
+            return &slots[front & mask];
+        }
+
+        bool Drop() {
+            size_t front = head.load(std::memory_order_relaxed);
+            if (front == tail.load(std::memory_order_acquire)) return false;
+            head.store(front + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Full() const {
+            return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) > mask;
+        }
+
+        size_t Size() const {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+};
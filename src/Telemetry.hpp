@@ -0,0 +1,454 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <ctime>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+
+#include "HdrHistogram.hpp"
+
+#if defined(_WIN32)
+// windows.h clashes with raylib's names, so only the file mapping calls are declared.
+extern "C" {
+    __declspec(dllimport) void* __stdcall CreateFileA(const char* name, unsigned long access, unsigned long share, void* security, unsigned long disposition, unsigned long flags, void* templateFile);
+    __declspec(dllimport) void* __stdcall CreateFileMappingA(void* file, void* security, unsigned long protect, unsigned long sizeHigh, unsigned long sizeLow, const char* name);
+    __declspec(dllimport) void* __stdcall MapViewOfFile(void* mapping, unsigned long access, unsigned long offsetHigh, unsigned long offsetLow, size_t bytes);
+    __declspec(dllimport) int __stdcall UnmapViewOfFile(const void* address);
+    __declspec(dllimport) int __stdcall CloseHandle(void* handle);
+}
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+// A file of fixed size mapped read-write into memory. Writes land in the page cache and reach the disk whenever
+// the OS gets to them, so the writer never waits on the device.
+class MappedFile {
+    private:
+        uint8_t* data = nullptr;
+        size_t size = 0;
+#if defined(_WIN32)
+        void* file = nullptr;
+        void* mapping = nullptr;
+#else
+        int descriptor = -1;
+#endif
+
+    public:
+        ~MappedFile() {
+            Close();
+        }
+
+        // Creates the file or resizes an existing one to `bytes`.
+        bool Open(const std::string& path, size_t bytes) {
+            Close();
+#if defined(_WIN32)
+            file = CreateFileA(path.c_str(), 0x80000000ul | 0x40000000ul, 1, nullptr, 4, 0x80, nullptr);
+            if (file == (void*) -1) { file = nullptr; return false; }
+
+            mapping = CreateFileMappingA(file, nullptr, 4, (unsigned long) ((uint64_t) bytes >> 32), (unsigned long) bytes, nullptr);
+            if (mapping) data = (uint8_t*) MapViewOfFile(mapping, 2, 0, 0, bytes);
+#else
+            descriptor = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (descriptor < 0) return false;
+
+            if (ftruncate(descriptor, (off_t) bytes) == 0) {
+                void* address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+                if (address != MAP_FAILED) data = (uint8_t*) address;
+            }
+#endif
+            if (!data) { Close(); return false; }
+            size = bytes;
+            return true;
+        }
+
+        void Close() {
+#if defined(_WIN32)
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (file) CloseHandle(file);
+            mapping = file = nullptr;
+#else
+            if (data) munmap(data, size);
+            if (descriptor >= 0) close(descriptor);
+            descriptor = -1;
+#endif
+            data = nullptr, size = 0;
+        }
+
+        uint8_t* Data() const { return data; }
+        size_t Size() const { return size; }
+};
+
+// On-disk layout. Each log file starts with a header, then holds records back to back up to `used`. An interval
+// record is a TelemetryInterval followed, per stage, by a TelemetryStage and its non-empty buckets as (index, count)
+// pairs, then by the hitches, each a time since the session started and one value per stage. Values are in
+// microseconds. `used` is only advanced once a record is complete, so a crash never leaves a torn record behind.
+struct TelemetryFileHeader {
+    char magic[8];
+    uint32_t version, headerBytes;
+    uint64_t created, used, session, size;
+};
+
+struct TelemetryRecordHeader {
+    uint32_t type, bytes;
+};
+
+struct TelemetryInterval {
+    uint64_t session, start, end;
+    uint32_t frames, stages, hitches, dropped;
+};
+
+struct TelemetryStage {
+    char name[16];
+    uint64_t total, minimum, maximum, sum;
+    uint32_t buckets, reserved;
+};
+
+// Frame, stage and hitch telemetry for one session. The render thread records into the active interval's
+// histograms, a few nanoseconds per frame with no locks, clock reads or allocations. Every flushPeriod of frame
+// time the interval is handed to a writer thread, which appends it to a ring of memory-mapped log files and clears
+// it. If the writer still holds the previous interval the hand-over is skipped and the interval simply runs longer,
+// so the render thread never waits on it.
+class Telemetry {
+    public:
+        enum Stage { FrameInterval, Work, Sleep, Post, Stages };
+        static constexpr uint32_t intervalRecord = 1, version = 1;
+        static constexpr int maxHitches = 64;
+
+        static const char* Name(int stage) {
+            static const char* const names[Stages] = { "frame", "work", "sleep", "post" };
+            return names[stage];
+        }
+
+    private:
+        struct Hitch {
+            uint64_t time;
+            uint32_t values[Stages];
+        };
+
+        struct Interval {
+            uint64_t start = 0, end = 0;
+            uint32_t frames = 0, hitches = 0, dropped = 0;
+            HdrHistogram stages[Stages];
+            Hitch hitchList[maxHitches];
+
+            void Reset() {
+                start = end = 0, frames = hitches = dropped = 0;
+                for (HdrHistogram& stage : stages) stage.Reset();
+            }
+        };
+
+        const std::string directory;
+        const size_t fileBytes;
+        const int files;
+        const uint64_t flushPeriod, hitchThreshold, session;
+
+        std::unique_ptr<Interval[]> intervals;
+        int active = 0;
+        uint64_t clock = 0, nextFlush;
+        std::atomic<int> handed { -1 };
+        std::atomic<bool> running { false };
+        std::atomic<uint64_t> written { 0 };
+        std::thread writer;
+
+        // Writer thread only.
+        MappedFile file;
+        int slot = -1;
+        std::vector<uint8_t> record;
+
+        static uint64_t WallMicros() {
+            return (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        std::string Path(int index) const {
+            return directory + "/telemetry-" + std::to_string(index) + ".bin";
+        }
+
+        TelemetryFileHeader* Header() const {
+            return (TelemetryFileHeader*) file.Data();
+        }
+
+        // Continues in the file written longest ago, or the first one missing, and starts it over.
+        bool Rotate() {
+            if (slot < 0) {
+                uint64_t oldest = ~uint64_t(0);
+                slot = 0;
+
+                for (int i = 0; i < files; i++) {
+                    TelemetryFileHeader header = {};
+                    std::FILE* existing = std::fopen(Path(i).c_str(), "rb");
+                    bool valid = existing && std::fread(&header, sizeof(header), 1, existing) == 1 && std::memcmp(header.magic, "CRAWLTLM", 8) == 0;
+                    if (existing) std::fclose(existing);
+
+                    uint64_t created = valid ? header.created : 0;
+                    if (created < oldest) oldest = created, slot = i;
+                }
+            } else {
+                slot = (slot + 1) % files;
+            }
+
+            if (!file.Open(Path(slot), fileBytes)) return false;
+
+            TelemetryFileHeader header = {};
+            std::memcpy(header.magic, "CRAWLTLM", 8);
+            header.version = version, header.headerBytes = sizeof(header);
+            header.created = WallMicros(), header.used = sizeof(header), header.session = session, header.size = fileBytes;
+            std::memcpy(file.Data(), &header, sizeof(header));
+            return true;
+        }
+
+        template <typename T>
+        void Put(const T& value) {
+            const uint8_t* bytes = (const uint8_t*) &value;
+            record.insert(record.end(), bytes, bytes + sizeof(T));
+        }
+
+        void Write(const Interval& interval) {
+            record.clear();
+            Put(TelemetryRecordHeader { intervalRecord, 0 });
+            Put(TelemetryInterval { session, interval.start, interval.end, interval.frames, Stages, interval.hitches, interval.dropped });
+
+            for (int i = 0; i < Stages; i++) {
+                const HdrHistogram& histogram = interval.stages[i];
+                TelemetryStage stage = {};
+                std::strncpy(stage.name, Name(i), sizeof(stage.name) - 1);
+                stage.total = histogram.Total(), stage.minimum = histogram.Min(), stage.maximum = histogram.Max(), stage.sum = histogram.Sum();
+
+                const size_t at = record.size();
+                Put(stage);
+
+                for (int bucket = 0; bucket < HdrHistogram::buckets; bucket++)
+                    if (uint32_t count = histogram.Count(bucket)) Put((uint32_t) bucket), Put(count), stage.buckets++;
+
+                std::memcpy(record.data() + at, &stage, sizeof(stage));
+            }
+
+            for (uint32_t i = 0; i < interval.hitches; i++) Put(interval.hitchList[i]);
+
+            const uint32_t bytes = (uint32_t) record.size();
+            std::memcpy(record.data() + offsetof(TelemetryRecordHeader, bytes), &bytes, sizeof(bytes));
+
+            if (!file.Data() || Header()->used + bytes > file.Size())
+                if (!Rotate() || Header()->used + bytes > file.Size()) return;
+
+            std::memcpy(file.Data() + Header()->used, record.data(), bytes);
+            Header()->used += bytes;
+            written.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Drain() {
+            while (true) {
+                const int index = handed.load(std::memory_order_acquire);
+
+                if (index >= 0) {
+                    Write(intervals[index]);
+                    intervals[index].Reset();
+                    handed.store(-1, std::memory_order_release);
+                } else if (!running.load(std::memory_order_acquire)) {
+                    break;
+                } else {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+            }
+
+            file.Close();
+        }
+
+        // Hands the active interval to the writer, unless it is still busy with the last one.
+        bool Flush() {
+            if (handed.load(std::memory_order_acquire) >= 0) return false;
+
+            const uint64_t now = WallMicros();
+            intervals[active].end = now;
+            handed.store(active, std::memory_order_release);
+
+            active ^= 1;
+            intervals[active].start = now;
+            nextFlush = clock + flushPeriod;
+            return true;
+        }
+
+    public:
+        Telemetry(const std::string& directory, size_t fileBytes = 4 << 20, int files = 4, double flushSeconds = 10.0, double hitchMilliseconds = 50.0)
+            : directory(directory), fileBytes(fileBytes), files(std::max(1, files)), flushPeriod((uint64_t) (flushSeconds * 1e6)),
+              hitchThreshold((uint64_t) (hitchMilliseconds * 1e3)), session(WallMicros()), intervals(new Interval[2]), nextFlush(flushPeriod) {
+            intervals[0].start = session;
+        }
+
+        ~Telemetry() {
+            Stop();
+        }
+
+        void Start() {
+            if (running.exchange(true)) return;
+            std::error_code error;
+            std::filesystem::create_directories(directory, error);
+            writer = std::thread(&Telemetry::Drain, this);
+        }
+
+        // Hands over what is left, waiting for the writer this once, and lets it finish.
+        void Stop() {
+            if (!running.load()) return;
+            while (!Flush()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            running.store(false, std::memory_order_release);
+            writer.join();
+        }
+
+        // Render thread, once per presented frame, with every stage in microseconds. Time is kept as the sum of
+        // frame intervals, so no clock is read here.
+        void Frame(const uint32_t (&values)[Stages]) {
+            Interval& interval = intervals[active];
+            for (int i = 0; i < Stages; i++) interval.stages[i].Record(values[i]);
+            interval.frames++, clock += values[FrameInterval];
+
+            if (values[FrameInterval] >= hitchThreshold) {
+                if (interval.hitches < maxHitches) {
+                    Hitch& hitch = interval.hitchList[interval.hitches++];
+                    hitch.time = clock;
+                    std::memcpy(hitch.values, values, sizeof(hitch.values));
+                } else {
+                    interval.dropped++;
+                }
+            }
+
+            if (clock >= nextFlush) Flush();
+        }
+
+        uint64_t Written() const {
+            return written.load(std::memory_order_relaxed);
+        }
+};
+
+// Prints every interval in the log files under `directory`, oldest first, then the distribution of each stage over
+// all of them. Returns non-zero when no valid log was found.
+inline int PrintTelemetry(const std::string& directory) {
+    struct Loaded {
+        std::string path;
+        TelemetryFileHeader header;
+        std::vector<uint8_t> bytes;
+    };
+
+    std::vector<Loaded> logs;
+    std::error_code error;
+
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("telemetry-", 0) != 0 || entry.path().extension() != ".bin") continue;
+
+        Loaded log;
+        log.path = entry.path().string();
+        std::FILE* file = std::fopen(entry.path().string().c_str(), "rb");
+        if (!file) continue;
+
+        bool valid = std::fread(&log.header, sizeof(log.header), 1, file) == 1 && std::memcmp(log.header.magic, "CRAWLTLM", 8) == 0 &&
+            log.header.version == Telemetry::version && log.header.used >= sizeof(log.header) && log.header.used <= log.header.size;
+
+        if (valid) {
+            log.bytes.resize((size_t) log.header.used - sizeof(log.header));
+            valid = log.bytes.empty() || std::fread(log.bytes.data(), log.bytes.size(), 1, file) == 1;
+            if (!valid) std::printf("skipping %s: shorter than its header says\n", log.path.c_str());
+        }
+
+        std::fclose(file);
+        if (valid) logs.push_back(std::move(log));
+    }
+
+    if (logs.empty()) {
+        std::printf("no telemetry logs in %s\n", directory.c_str());
+        return 1;
+    }
+
+    std::sort(logs.begin(), logs.end(), [](const Loaded& a, const Loaded& b) { return a.header.created < b.header.created; });
+
+    std::vector<std::string> names;
+    std::vector<HdrHistogram> totals;
+    uint64_t intervals = 0, hitches = 0;
+
+    std::printf("%-18s %-10s %8s %8s", "session", "start", "seconds", "frames");
+    for (int i = 0; i < Telemetry::Stages; i++) std::printf(" %14s", (std::string(Telemetry::Name(i)) + " p50/p99").c_str());
+    std::printf(" %8s\n", "hitches");
+
+    // Every read is checked against the end of its record, which the header has already checked against the log,
+    // so a damaged log stops the report instead of reading past it.
+    const char* malformed = nullptr;
+    std::string where;
+
+    for (const Loaded& log : logs) {
+        for (size_t at = 0; at + sizeof(TelemetryRecordHeader) <= log.bytes.size() && !malformed;) {
+            TelemetryRecordHeader header;
+            std::memcpy(&header, log.bytes.data() + at, sizeof(header));
+            where = log.path + " at byte " + std::to_string(sizeof(TelemetryFileHeader) + at);
+
+            if (header.bytes < sizeof(header) || header.bytes > log.bytes.size() - at) { malformed = "record runs past the end of the log"; break; }
+
+            const uint8_t* cursor = log.bytes.data() + at + sizeof(header);
+            const uint8_t* end = log.bytes.data() + at + header.bytes;
+            at += header.bytes;
+            if (header.type != Telemetry::intervalRecord) continue;
+
+            TelemetryInterval interval;
+            if ((size_t) (end - cursor) < sizeof(interval)) { malformed = "interval is truncated"; break; }
+            std::memcpy(&interval, cursor, sizeof(interval)), cursor += sizeof(interval);
+            if (interval.stages > (size_t) (end - cursor) / sizeof(TelemetryStage)) { malformed = "stage count does not fit the record"; break; }
+            if (totals.size() < interval.stages) totals.resize(interval.stages), names.resize(interval.stages);
+
+            const time_t start = (time_t) (interval.start / 1000000);
+            char when[16];
+            std::strftime(when, sizeof(when), "%H:%M:%S", std::localtime(&start));
+            std::printf("%-18llu %-10s %8.1f %8u", (unsigned long long) interval.session, when, (interval.end - interval.start) / 1e6, interval.frames);
+
+            for (uint32_t i = 0; i < interval.stages && !malformed; i++) {
+                TelemetryStage stage;
+                if ((size_t) (end - cursor) < sizeof(stage)) { malformed = "stage is truncated"; break; }
+                std::memcpy(&stage, cursor, sizeof(stage)), cursor += sizeof(stage);
+                stage.name[sizeof(stage.name) - 1] = '\0', names[i] = stage.name;
+
+                if (stage.buckets > (size_t) (end - cursor) / 8) { malformed = "bucket count does not fit the record"; break; }
+
+                HdrHistogram histogram;
+                for (uint32_t b = 0; b < stage.buckets; b++, cursor += 8) {
+                    uint32_t pair[2];
+                    std::memcpy(pair, cursor, sizeof(pair));
+                    histogram.Add((int) pair[0], pair[1]);
+                }
+
+                totals[i].Merge(histogram);
+                char cell[32];
+                std::snprintf(cell, sizeof(cell), "%.2f/%.2f", histogram.Percentile(0.5) / 1e3, histogram.Percentile(0.99) / 1e3);
+                std::printf(" %14s", cell);
+            }
+
+            if (malformed) { std::printf("\n"); break; }
+
+            std::printf(" %8u%s\n", interval.hitches, interval.dropped ? "+" : "");
+            intervals++, hitches += interval.hitches + interval.dropped;
+        }
+
+        if (malformed) break;
+    }
+
+    std::printf("\n%llu intervals, %llu hitches\n%-8s %10s %10s %10s %10s %10s %10s\n", (unsigned long long) intervals, (unsigned long long) hitches,
+        "stage", "frames", "mean ms", "p50 ms", "p99 ms", "p99.9 ms", "max ms");
+
+    for (size_t i = 0; i < totals.size(); i++)
+        std::printf("%-8s %10llu %10.3f %10.3f %10.3f %10.3f %10.3f\n", names[i].c_str(), (unsigned long long) totals[i].Total(), totals[i].Mean() / 1e3,
+            totals[i].Percentile(0.5) / 1e3, totals[i].Percentile(0.99) / 1e3, totals[i].Percentile(0.999) / 1e3, totals[i].Max() / 1e3);
+
+    if (malformed) {
+        std::printf("malformed telemetry in %s: %s; the totals above stop there\n", where.c_str(), malformed);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+#include <raylib/raylib.h>
+
+#include "SpscQueue.hpp"
+#include "Solvability.hpp"
+
+struct TrackChunk {
+    static constexpr int size = 64;
+
+    uint64_t run = 0;
+    uint32_t index = 0;
+    int startHue = 0, endHue = 0;
+    bool endHueState = true;
+    Solvability::State reachable;
+    int repaired = 0;
+
+    float lanes[size];
+    int hues[size];
+    Color colors[size];
+};
+
+struct Spawn {
+    float lane;
+    int hue;
+    Color color;
+};
+
+// Produces the obstacle sequence of every run in chunks of TrackChunk::size on a worker thread. Lanes come from
+// a counter-based hash of (seed, run, obstacle index), so any chunk can be rebuilt from the end state of the one
+// before it; the consumer falls back to doing exactly that when the worker has not caught up. Runs are numbered
+// by the consumer in the order they begin, so a seed always plays the same runs whichever side built them; the
+// worker only prepares the first chunks of the runs it expects next.
+class TrackGenerator {
+    private:
+        static constexpr uint64_t noRun = ~uint64_t(0);
+
+        const uint64_t seed;
+        SpscQueue<TrackChunk> starts, ahead;
+        std::atomic<uint64_t> nextRun { 0 }, activeRun { noRun };
+        std::atomic<bool> running { false };
+        std::thread worker;
+
+        TrackChunk current;
+        int cursor = TrackChunk::size;
+
+        void Work() {
+            TrackChunk pending;
+            uint64_t generating = noRun, queued = 0;
+            bool hasPending = false;
+
+            while (running.load(std::memory_order_relaxed)) {
+                bool idle = true;
+
+                // Runs the consumer has already begun without waiting for the queue are skipped.
+                queued = std::max(queued, nextRun.load(std::memory_order_acquire));
+                if (!starts.Full()) {
+                    starts.TryPush(First(seed, queued++));
+                    idle = false;
+                }
+
+                uint64_t active = activeRun.load(std::memory_order_acquire);
+
+                if (active != generating) {
+                    TrackChunk first = First(seed, active);
+                    Generate(seed, first, pending);
+                    generating = active, hasPending = true;
+                }
+
+                if (generating != noRun && !hasPending) {
+                    TrackChunk previous = pending;
+                    Generate(seed, previous, pending);
+                    hasPending = true;
+                }
+
+                if (hasPending && ahead.TryPush(pending)) {
+                    hasPending = false, idle = false;
+                }
+
+                if (idle) std::this_thread::sleep_for(std::chrono::microseconds(500));
+            }
+        }
+
+    public:
+        TrackGenerator(uint64_t seed, size_t lookahead = 16) : seed(seed), starts(4), ahead(lookahead) {}
+
+        ~TrackGenerator() {
+            Stop();
+        }
+
+        static uint64_t Mix(uint64_t value) {
+            value += 0x9E3779B97F4A7C15ull;
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+            return value ^ (value >> 31);
+        }
+
+        static void ChangeHue(int& hue, bool& hueState) {
+            if (hue >= 360) hueState = false;
+            if (hue <= 0) hueState = true;
+            if (hueState) { hue++; }
+            else { hue--; }
+        }
+
+        static float Lane(uint64_t seed, uint64_t run, uint64_t obstacle, uint64_t attempt = 0) {
+            uint64_t key = Mix(Mix(seed ^ Mix(run)) + obstacle);
+            if (attempt != 0) key = Mix(key ^ Mix(attempt));
+            return (float) ((key % 8) + 1) - 4;
+        }
+
+        // Picks the lane for one obstacle, re-rolling it while it would leave the player nowhere to go at the
+        // speed it will be reached at, then scanning every lane. When even that fails the player is left with
+        // nothing but too much lag, so the obstacle goes wherever it is furthest from them and the model starts
+        // over from whichever position it leaves them.
+        static float SolvableLane(uint64_t seed, uint64_t run, uint64_t obstacle, Solvability::State& reachable, int& repaired) {
+            const float speed = Solvability::SpeedAt(obstacle);
+
+            for (uint64_t attempt = 0; attempt < 16; attempt++) {
+                float lane = Lane(seed, run, obstacle, attempt);
+
+                if (Solvability::Pass(reachable, lane, speed)) {
+                    repaired += attempt != 0;
+                    return lane;
+                }
+            }
+
+            repaired++;
+            for (int lane = -3; lane <= 4; lane++)
+                if (Solvability::Pass(reachable, (float) lane, speed)) return (float) lane;
+
+            int settled = -1;
+            for (int bit = 0; bit < Solvability::positions; bit++)
+                if ((reachable.reachable >> bit & 1) && (settled < 0 || std::fabs(reachable.lag[bit]) < std::fabs(reachable.lag[settled]))) settled = bit;
+
+            const float x = Solvability::Position(settled) + reachable.lag[settled];
+            const float lane = x < 0.5f ? 4.0f : -3.0f;
+            reachable = Solvability::State();
+            reachable.reachable = uint64_t(1) << Solvability::Bit(x);
+            return lane;
+        }
+
+        // Fills `chunk` with the obstacles that follow `previous` in the same run.
+        static void Generate(uint64_t seed, const TrackChunk& previous, TrackChunk& chunk) {
+            int hue = previous.endHue;
+            bool hueState = previous.endHueState;
+            Solvability::State reachable = previous.reachable;
+            chunk.run = previous.run, chunk.index = previous.index + 1, chunk.startHue = previous.startHue, chunk.repaired = 0;
+
+            for (int i = 0; i < TrackChunk::size; i++) {
+                ChangeHue(hue, hueState);
+                chunk.lanes[i] = SolvableLane(seed, chunk.run, (uint64_t) chunk.index * TrackChunk::size + i, reachable, chunk.repaired);
+                chunk.hues[i] = hue;
+                chunk.colors[i] = ColorFromHSV((float) hue, 1, 1);
+            }
+
+            chunk.endHue = hue, chunk.endHueState = hueState, chunk.reachable = reachable;
+        }
+
+        static TrackChunk First(uint64_t seed, uint64_t run) {
+            TrackChunk start, chunk;
+            start.run = run, start.index = ~uint32_t(0);
+            start.startHue = start.endHue = (int) (Mix(seed ^ Mix(run) ^ 0x68756Eull) % 32768), start.endHueState = true;
+            start.reachable = Solvability::Begin();
+            Generate(seed, start, chunk);
+            return chunk;
+        }
+
+        void Start() {
+            if (running.exchange(true)) return;
+            worker = std::thread(&TrackGenerator::Work, this);
+        }
+
+        void Stop() {
+            running = false;
+            if (worker.joinable()) worker.join();
+        }
+
+        size_t Lookahead() const {
+            return ahead.Size();
+        }
+
+        // Consumer side: call from one thread only. Returns the hue the new run starts from.
+        int BeginRun() {
+            const uint64_t run = nextRun.load(std::memory_order_relaxed);
+            bool ready = false;
+
+            // Starts queued before the consumer last built its own are for runs already begun.
+            while (!ready && starts.TryPop(current)) ready = current.run == run;
+            if (!ready) current = First(seed, run);
+
+            nextRun.store(run + 1, std::memory_order_release);
+            activeRun.store(current.run, std::memory_order_release);
+            while (ahead.Drop());
+            cursor = 0;
+            return current.startHue;
+        }
+
+        // Where the consumer is within the current run. Rewind() returns to a position saved earlier in the same run.
+        const TrackChunk& Chunk() const {
+            return current;
+        }
+
+        int Cursor() const {
+            return cursor;
+        }
+
+        void Rewind(const TrackChunk& chunk, int position) {
+            current = chunk, cursor = position;
+        }
+
+        Spawn Next() {
+            if (cursor == TrackChunk::size) {
+                // Chunks of other runs or already used ones are skipped. After a rewind the worker is ahead of the
+                // consumer, so the chunks in between are rebuilt here until the queue lines up again.
+                while (const TrackChunk* front = ahead.Front()) {
+                    if (front->run == current.run && front->index > current.index) break;
+                    ahead.Drop();
+                }
+
+                const TrackChunk* front = ahead.Front();
+                if (front && front->index == current.index + 1) current = *front, ahead.Drop();
+                else { TrackChunk previous = current; Generate(seed, previous, current); }
+                cursor = 0;
+            }
+
+            int i = cursor++;
+            return { current.lanes[i], current.hues[i], current.colors[i] };
+        }
+};
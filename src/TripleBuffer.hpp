@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Single-producer single-consumer triple buffer. The writer fills Back() and publishes it; the reader always
+// gets the newest published value. Neither side ever blocks and neither can see a buffer the other is using.
+template <typename T>
+class TripleBuffer {
+    private:
+        static constexpr uint8_t fresh = 0x4, indexMask = 0x3;
+
+        T buffers[3];
+        std::atomic<uint8_t> middle { 1 };
+        uint8_t back = 0, front = 2;
+
+    public:
+        T& Back() {
+            return buffers[back];
+        }
+
+        void Publish() {
+            back = middle.exchange(back | fresh, std::memory_order_acq_rel) & indexMask;
+        }
+
+        // Returns true if a newer value was swapped in since the last call.
+        bool Update() {
+            if (!(middle.load(std::memory_order_relaxed) & fresh)) return false;
+            front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+            return true;
+        }
+
+        const T& Front() const {
+            return buffers[front];
+        }
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <raylib/raylib.h>
+
+struct ObstacleState {
+    Vector3 position, size;
+    Color color;
+};
+
+// Everything the renderer needs from one simulation tick. `sequence` is written first and `check` last, so a
+// reader that sees them disagree has observed a snapshot that was still being written.
+struct WorldSnapshot {
+    uint64_t sequence = 0;
+
+    Vector3 previousPosition = { 0.0f, 0.0f, 0.0f }, position = { 0.0f, 0.0f, 0.0f }, size = { 2.0f, 2.0f, 2.0f };
+    Color color = RAYWHITE;
+    Camera3D previousCamera = {}, camera = {};
+    std::vector<ObstacleState> obstacles;
+
+    double tickClock = 0.0, score = 0.0, origin = 0.0;
+    float alpha = 0.0f, speed = 0.0f, rewindable = 0.0f;
+    int hue = 0, maxObstacles = 0, runs = 0;
+    bool started = false, dead = false, paused = false, demo = false;
+
+    uint64_t check = 0;
+
+    bool Torn() const {
+        return sequence != check;
+    }
+};